@@ -68,17 +68,41 @@
  * See http://www.freertos.org/a00110.html.
  *----------------------------------------------------------*/
 
+/* Kernel event trace (drivers/trace.h), built with make TRACE=1 */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE				0
+#endif
+
+/* Debug build (make DEBUG=1): the stack of the task being switched out is
+ * checked at every context switch, see vApplicationStackOverflowHook() in
+ * drivers/supervisor.c. Worst cases are computed by make stack. */
+#ifndef DEBUG_ENABLE
+#define DEBUG_ENABLE				0
+#endif
+#if DEBUG_ENABLE
+#define configCHECK_FOR_STACK_OVERFLOW	2
+#endif
+
 #define configUSE_PREEMPTION		1
-//MODIFIED by Julien Deantoni --> no idle hook function required
-#define configUSE_IDLE_HOOK			0                             
-#define configUSE_TICK_HOOK			0
+// Idle and tick hooks are used for CPU load measurement (drivers/sysmon.c)
+#define configUSE_IDLE_HOOK			1
+#define configUSE_TICK_HOOK			1
 #define configCPU_CLOCK_HZ			( ( unsigned long ) F_CPU )
 #define configTICK_RATE_HZ			( ( portTickType ) 1000 )
 #define configMAX_PRIORITIES		( 4 )
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 85 )
-#define configTOTAL_HEAP_SIZE		( (size_t ) ( 1000 ) )
+/* Serial telemetry (drivers/telemetry.h), built with make TELEMETRY=1:
+ * its task and message buffer need about 300 more bytes of heap. */
+#ifndef TELEMETRY_ENABLE
+#define TELEMETRY_ENABLE			0
+#endif
+#if TELEMETRY_ENABLE
+#define configTOTAL_HEAP_SIZE		( (size_t ) ( 1100 + 300 ) )
+#else
+#define configTOTAL_HEAP_SIZE		( (size_t ) ( 1100 ) )
+#endif
 #define configMAX_TASK_NAME_LEN		( 4 )
-#define configUSE_TRACE_FACILITY	0
+#define configUSE_TRACE_FACILITY	TRACE_ENABLE
 #define configUSE_16_BIT_TICKS		1
 #define configIDLE_SHOULD_YIELD		1
 #define configQUEUE_REGISTRY_SIZE	0
@@ -105,5 +129,18 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
 
+/* Trace hooks: task numbers (uxTCBNumber) follow the creation order. */
+#if TRACE_ENABLE && !defined(__ASSEMBLER__)
+#include "trace.h"
+#define traceTASK_INCREMENT_TICK( xTickCount )	trace_tick = ( uint8_t ) ( ( xTickCount ) + 1 )
+#define traceTASK_SWITCHED_IN()					trace_record( TRACE_SWITCH_IN | ( pxCurrentTCB->uxTCBNumber & TRACE_ARG_MASK ) )
+#define traceTASK_DELAY()						trace_record( TRACE_DELAY | ( pxCurrentTCB->uxTCBNumber & TRACE_ARG_MASK ) )
+#define traceTASK_DELAY_UNTIL( xTimeToWake )	trace_record( TRACE_DELAY | ( pxCurrentTCB->uxTCBNumber & TRACE_ARG_MASK ) )
+#define traceQUEUE_SEND( pxQueue )				trace_record( TRACE_GIVE | ( ( pxQueue )->uxQueueNumber & TRACE_ARG_MASK ) )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )		trace_record( TRACE_GIVE | ( ( pxQueue )->uxQueueNumber & TRACE_ARG_MASK ) )
+#define traceQUEUE_RECEIVE( pxQueue )			trace_record( TRACE_TAKE | ( ( pxQueue )->uxQueueNumber & TRACE_ARG_MASK ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	trace_record( TRACE_BLOCK | ( ( pxQueue )->uxQueueNumber & TRACE_ARG_MASK ) )
+#endif
+
 
 #endif /* FREERTOS_CONFIG_H */
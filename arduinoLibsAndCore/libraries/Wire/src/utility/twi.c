@@ -37,6 +37,12 @@
 
 #include "pins_arduino.h"
 #include "twi.h"
+#include "trace.h"
+#include "soft_i2c.h"
+
+// ISR duration is measured on Timer1, which runs the FreeRTOS tick (CTC mode,
+// prescaler 64, see port.c): 4 us per step, wrapping at OCR1A.
+#define TWI_US_PER_STEP (64000000UL / F_CPU)
 
 static volatile uint8_t twi_state;
 static volatile uint8_t twi_slarw;
@@ -398,6 +404,8 @@ void twi_releaseBus(void)
 
 ISR(TWI_vect)
 {
+  TRACE_ISR_BEGIN(TRACE_ISR_TWI);
+  uint8_t isr_start = TCNT1L;
   switch(TW_STATUS){
     // All Master
     case TW_START:     // sent start condition
@@ -490,9 +498,11 @@ ISR(TWI_vect)
       if(twi_rxBufferIndex < TWI_BUFFER_LENGTH){
         // put byte in buffer and ack
         twi_rxBuffer[twi_rxBufferIndex++] = TWDR;
+        soft_i2c_bus_stats.bytes_in++;
         twi_reply(1);
       }else{
         // otherwise nack
+        soft_i2c_bus_stats.overruns++;
         twi_reply(0);
       }
       break;
@@ -504,6 +514,7 @@ ISR(TWI_vect)
         twi_rxBuffer[twi_rxBufferIndex] = '\0';
       }
       // callback to user defined callback
+      soft_i2c_bus_stats.writes++;
       twi_onSlaveReceive(twi_rxBuffer, twi_rxBufferIndex);
       // since we submit rx buffer to "wire" library, we can reset it
       twi_rxBufferIndex = 0;
@@ -519,6 +530,7 @@ ISR(TWI_vect)
     case TW_ST_ARB_LOST_SLA_ACK: // arbitration lost, returned ack
       // enter slave transmitter mode
       twi_state = TWI_STX;
+      soft_i2c_bus_stats.reads++;
       // ready the tx buffer index for iteration
       twi_txBufferIndex = 0;
       // set tx buffer length to be zero, to verify if user changes it
@@ -536,6 +548,7 @@ ISR(TWI_vect)
     case TW_ST_DATA_ACK: // byte sent, ack returned
       // copy data to output register
       TWDR = twi_txBuffer[twi_txBufferIndex++];
+      soft_i2c_bus_stats.bytes_out++;
       // if there is more to send, ack, otherwise nack
       if(twi_txBufferIndex < twi_txBufferLength){
         twi_reply(1);
@@ -556,8 +569,23 @@ ISR(TWI_vect)
       break;
     case TW_BUS_ERROR: // bus error, illegal stop/start
       twi_error = TW_BUS_ERROR;
+      soft_i2c_bus_stats.bus_errors++;
       twi_stop();
       break;
   }
+
+  // Timer1 restarts from 0 at each tick and an ISR never lasts a full tick:
+  // an end count below the start count means the counter wrapped once
+  uint8_t isr_end = TCNT1L;
+  uint16_t isr_steps = isr_end >= isr_start ? isr_end - isr_start
+                                            : isr_end + OCR1A + 1 - isr_start;
+  uint16_t isr_us = isr_steps * TWI_US_PER_STEP;
+  if(isr_us > soft_i2c_bus_stats.isr_max_us){
+    soft_i2c_bus_stats.isr_max_us = isr_us;
+  }
+  if(isr_us > SOFT_I2C_ISR_BUDGET_US){
+    soft_i2c_bus_stats.slow_isr++;
+  }
+  TRACE_ISR_END(TRACE_ISR_TWI);
 }
 
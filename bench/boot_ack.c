@@ -0,0 +1,182 @@
+/*
+ * Benchmark de démarrage sous simavr : temps entre le reset et
+ *   - le premier ACK de l'adresse I2C esclave,
+ *   - le premier status valide lu dans REG_SYSTEM_STATUS (BOOTING ou OK),
+ *   - le premier status OK (toutes les tâches tournent).
+ *
+ * Le programme joue le rôle du maître I2C (la Raspberry Pi) : toutes les
+ * POLL_US microsecondes simulées, il tente une lecture du registre de status
+ * comme le ferait smbus2.read_byte_data().
+ *
+ * Usage : boot_ack Build/ParkingRTOS.elf [timeout_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "avr_twi.h"
+
+#define SLAVE_ADDRESS       0x32
+#define REG_SYSTEM_STATUS   5
+
+#define SYS_STATUS_OK       0x01
+#define SYS_STATUS_STALLED  0x02
+#define SYS_STATUS_BOOTING  0x80
+
+#define F_CPU               16000000UL
+#define POLL_US             100     // Intervalle entre deux tentatives du maître
+#define ACK_TIMEOUT_US      500     // Au-delà, l'adresse est considérée NACK
+
+#define US_TO_CYCLES(us)    ((avr_cycle_count_t)(us) * (F_CPU / 1000000UL))
+
+enum master_state {
+    M_IDLE,
+    M_WAIT_ADDR_W_ACK,  // START + SLA+W envoyés
+    M_WAIT_REG_ACK,     // Numéro de registre envoyé
+    M_WAIT_ADDR_R_ACK,  // START répété + SLA+R envoyés
+    M_WAIT_DATA,        // Lecture d'un octet demandée
+};
+
+static avr_t *avr;
+static avr_irq_t *twi_in;
+static enum master_state state = M_IDLE;
+static avr_cycle_count_t request_cycle;
+
+static avr_cycle_count_t first_ack = 0;
+static avr_cycle_count_t first_valid = 0;
+static avr_cycle_count_t first_ok = 0;
+static unsigned attempts = 0;
+
+static void master_send(uint8_t msg, uint8_t addr, uint8_t data)
+{
+    request_cycle = avr->cycle;
+    avr_raise_irq(twi_in, avr_twi_irq_msg(msg, addr, data));
+}
+
+static void master_abort(void)
+{
+    avr_raise_irq(twi_in, avr_twi_irq_msg(TWI_COND_STOP, SLAVE_ADDRESS << 1, 0));
+    state = M_IDLE;
+}
+
+// Réponses de l'AVR esclave (ACK et octets lus)
+static void twi_output_hook(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    avr_twi_msg_irq_t v = { .u.v = value };
+
+    switch (state)
+    {
+    case M_WAIT_ADDR_W_ACK:
+        if (!(v.u.twi.msg & TWI_COND_ACK) || !v.u.twi.data)
+            break;
+        if (!first_ack)
+            first_ack = avr->cycle;
+        state = M_WAIT_REG_ACK;
+        master_send(TWI_COND_WRITE, SLAVE_ADDRESS << 1, REG_SYSTEM_STATUS);
+        break;
+
+    case M_WAIT_REG_ACK:
+        if (!(v.u.twi.msg & TWI_COND_ACK) || !v.u.twi.data)
+            break;
+        state = M_WAIT_ADDR_R_ACK;
+        master_send(TWI_COND_START, (SLAVE_ADDRESS << 1) | 1, 0);
+        break;
+
+    case M_WAIT_ADDR_R_ACK:
+        if (!(v.u.twi.msg & TWI_COND_ACK) || !v.u.twi.data)
+            break;
+        state = M_WAIT_DATA;
+        master_send(TWI_COND_READ, (SLAVE_ADDRESS << 1) | 1, 0);
+        break;
+
+    case M_WAIT_DATA:
+        if (!(v.u.twi.msg & TWI_COND_READ))
+            break;
+        {
+            uint8_t status = v.u.twi.data;
+            if (!first_valid && (status == SYS_STATUS_BOOTING ||
+                                 status == SYS_STATUS_OK ||
+                                 status == SYS_STATUS_STALLED))
+                first_valid = avr->cycle;
+            if (!first_ok && status == SYS_STATUS_OK)
+                first_ok = avr->cycle;
+        }
+        master_abort();
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Timer simavr : lance une nouvelle transaction ou abandonne celle en cours
+static avr_cycle_count_t master_poll(avr_t *a, avr_cycle_count_t when, void *param)
+{
+    if (state != M_IDLE && a->cycle - request_cycle > US_TO_CYCLES(ACK_TIMEOUT_US))
+        master_abort();
+
+    if (state == M_IDLE)
+    {
+        attempts++;
+        state = M_WAIT_ADDR_W_ACK;
+        master_send(TWI_COND_START, SLAVE_ADDRESS << 1, 0);
+    }
+
+    return when + US_TO_CYCLES(POLL_US);
+}
+
+static double cycles_to_ms(avr_cycle_count_t c)
+{
+    return (double)c * 1000.0 / F_CPU;
+}
+
+int main(int argc, char *argv[])
+{
+    elf_firmware_t firmware = {{0}};
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s firmware.elf [timeout_ms]\n", argv[0]);
+        return 2;
+    }
+    unsigned timeout_ms = argc > 2 ? (unsigned)atoi(argv[2]) : 2000;
+
+    if (elf_read_firmware(argv[1], &firmware) != 0)
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+
+    avr = avr_make_mcu_by_name("atmega328p");
+    if (!avr)
+    {
+        fprintf(stderr, "simavr: atmega328p not supported\n");
+        return 2;
+    }
+    avr_init(avr);
+    avr->frequency = F_CPU;
+    avr_load_firmware(avr, &firmware);
+
+    twi_in = avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+                            twi_output_hook, NULL);
+    avr_cycle_timer_register(avr, US_TO_CYCLES(POLL_US), master_poll, NULL);
+
+    avr_cycle_count_t deadline = US_TO_CYCLES(timeout_ms * 1000UL);
+    int cpu_state = cpu_Running;
+    while (!first_ok && avr->cycle < deadline &&
+           cpu_state != cpu_Done && cpu_state != cpu_Crashed)
+        cpu_state = avr_run(avr);
+
+    printf("reset -> first ACK          : %8.3f ms\n", first_ack ? cycles_to_ms(first_ack) : -1.0);
+    printf("reset -> first valid status : %8.3f ms\n", first_valid ? cycles_to_ms(first_valid) : -1.0);
+    printf("reset -> first OK status    : %8.3f ms\n", first_ok ? cycles_to_ms(first_ok) : -1.0);
+    printf("master attempts             : %u (every %u us)\n", attempts, POLL_US);
+
+    avr_terminate(avr);
+    return (first_ack && first_valid) ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Build hôte (bench/traffic_sim.cpp) : les modules des drivers qui ne
+// dépendent du noyau que par ses sections critiques sont compilés tels
+// quels, en un seul fil d'exécution.
+
+#endif
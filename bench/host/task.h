@@ -0,0 +1,8 @@
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+// Voir FreeRTOS.h : ni tâche ni interruption à exclure sur l'hôte
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif
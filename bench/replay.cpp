@@ -0,0 +1,438 @@
+/*
+ * Rejeu déterministe de la logique du parking sur la machine hôte : le même
+ * ParkingController que la tâche servo (drivers/parking_controller.h), un
+ * cycle toutes les SERVO_PERIOD_MS de temps simulé, sans FreeRTOS ni AVR.
+ *
+ * Entrée : une capture d'événements au format de i2c_master.py --events
+ * (ou la sortie de ce programme), une ligne par événement :
+ *     [    12.345 s] car[0]   = 1
+ * car[n] et light sont des entrées. mode et, en mode manuel, barrier sont
+ * les commandes du master telles qu'elles apparaissent dans la capture :
+ * mode=1 lance un mode manuel, chaque position capturée ensuite est rejouée,
+ * mode=0 revient en automatique. Les autres lignes sont ignorées.
+ *
+ * Sortie : le flux rejoué dans le même format (entrées comprises, il peut
+ * donc être rejoué à son tour), puis la comparaison avec les événements
+ * barrier (en automatique) et led de la capture. Les tâches du firmware
+ * tournent à des périodes différentes : un écart de TOLERANCE_MS est admis.
+ *
+ * Ce qui n'est pas une fonction pure n'est pas modélisé : maintien fixe
+ * (pas de politique adaptative), pas de pré-ouverture ni de programme de
+ * barrière autre que les positions capturées.
+ *
+ * --synthetic N : N cycles d'un trafic pseudo-aléatoire (graine fixe,
+ * toutes les places), pour mesurer le débit du contrôleur.
+ *
+ * Usage : replay [options] capture.txt | replay [options] --synthetic N
+ *   --hold-ms MS      maintien après le départ (barrier_hold_ms, 5000)
+ *   --open-angle DEG  angle d'ouverture (120)
+ *   --tolerance MS    écart admis à la comparaison (TOLERANCE_MS)
+ *   --seed S          graine du trafic synthétique
+ *   -q                pas de flux rejoué, seulement le bilan
+ *   -v                flux rejoué aussi en mode synthétique
+ * Code de retour 1 si le rejeu diverge de la capture.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+#include "parking_controller.h"
+
+#ifndef SPOT_COUNT
+#define SPOT_COUNT          1
+#endif
+
+#define SERVO_PERIOD_MS     50
+#define TOLERANCE_MS        150     // Période IR (80 ms) + période servo + marge
+#define LINE_SIZE           128
+
+typedef ParkingController<SPOT_COUNT> Controller;
+
+static const char *const event_names[] = { "?", "car", "light", "barrier", "led", "mode", "direction" };
+
+typedef struct
+{
+    uint32_t ms;
+    uint8_t  type;
+    uint8_t  spot;                  // EVENT_CAR
+    uint8_t  value;
+} record_t;
+
+static struct
+{
+    uint16_t hold_ms;
+    uint8_t  open_angle;
+    uint32_t tolerance_ms;
+    uint32_t seed;
+    bool     quiet;
+    bool     verbose;
+} options = { 5000, 120, TOLERANCE_MS, 1, false, false };
+
+static void print_record(const record_t *r)
+{
+    char name[16];
+
+    if (r->type == EVENT_CAR)
+        snprintf(name, sizeof(name), "car[%u]", r->spot);
+    else
+        snprintf(name, sizeof(name), "%s", event_names[r->type]);
+    printf("[%10.3f s] %-8s = %u\n", r->ms / 1000.0, name, r->value);
+}
+
+// "[    12.345 s] car[0]   = 1" -> record ; 0 si la ligne n'est pas un événement
+static int parse_line(const char *line, record_t *r)
+{
+    double seconds;
+    char name[16];
+    int value;
+    unsigned spot;
+
+    if (sscanf(line, " [%lf s] %15[^ =] = %d", &seconds, name, &value) != 3)
+        return 0;
+
+    r->ms = (uint32_t)(seconds * 1000.0 + 0.5);
+    r->spot = 0;
+    r->value = (uint8_t)value;
+    if (sscanf(name, "car[%u]", &spot) == 1)
+    {
+        r->type = EVENT_CAR;
+        r->spot = spot;
+        return spot < SPOT_COUNT;
+    }
+    if (strcmp(name, "car") == 0)
+    {
+        // Valeur brute de l'enregistrement : bit 0 = voiture, bits 1-7 = place
+        r->type = EVENT_CAR;
+        r->spot = value >> 1;
+        r->value = value & 1;
+        return r->spot < SPOT_COUNT;
+    }
+    for (uint8_t t = EVENT_LIGHT; t <= EVENT_MODE; t++)
+    {
+        if (strcmp(name, event_names[t]) == 0)
+        {
+            r->type = t;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Etat du rejeu entre deux cycles
+typedef struct
+{
+    Controller controller;
+    uint16_t occupancy;
+    bool     dark;
+    uint8_t  led_state;
+    ControllerInputs in;            // Commandes reçues depuis le cycle précédent
+} replay_t;
+
+static void replay_init(replay_t *s)
+{
+    s->occupancy = 0;
+    s->dark = false;
+    s->led_state = 0xFF;            // Premier cycle journalisé, comme prev_led_state
+    s->in.servo_command = CONTROLLER_CMD_NONE;
+    s->in.program = 0;
+    s->in.program_angle = CONTROLLER_NO_MOVE;
+}
+
+// Un cycle de la tâche servo suivi d'un cycle de la tâche LEDs. Les sorties
+// sont ajoutées à `out` si non nul ; retourne le nombre d'événements.
+static unsigned replay_step(replay_t *s, uint32_t now, std::vector<record_t> *out)
+{
+    ControllerOutputs o;
+    ControllerInputs *in = &s->in;
+    unsigned count;
+
+    in->occupancy = s->occupancy;
+    in->lane_hold = in->spot_hold = options.hold_ms / SERVO_PERIOD_MS;
+    in->open_angle = options.open_angle;
+    in->preopen_angle = 0;
+    s->controller.step(*in, now, o);
+
+    in->servo_command = CONTROLLER_CMD_NONE;
+    in->program = 0;
+    in->program_angle = CONTROLLER_NO_MOVE;
+
+    count = o.event_count;
+    if (out)
+    {
+        for (uint8_t i = 0; i < o.event_count; i++)
+        {
+            record_t r = { now, o.events[i].type, 0, o.events[i].value };
+            out->push_back(r);
+        }
+    }
+
+    uint8_t led_state = Controller::leds(s->dark, s->occupancy & 1, s->controller.released(0));
+    if (led_state != s->led_state)
+    {
+        s->led_state = led_state;
+        count++;
+        if (out)
+        {
+            record_t r = { now, EVENT_LED, 0, led_state };
+            out->push_back(r);
+        }
+    }
+    return count;
+}
+
+// Applique une entrée de la capture. Retourne 1 si c'est une commande ou un
+// capteur, 0 si c'est une sortie à comparer.
+static int replay_input(replay_t *s, const record_t *r, bool *manual)
+{
+    switch (r->type)
+    {
+    case EVENT_CAR:
+        if (r->value)
+            s->occupancy |= 1u << r->spot;
+        else
+            s->occupancy &= ~(1u << r->spot);
+        return 1;
+    case EVENT_LIGHT:
+        s->dark = r->value;
+        return 1;
+    case EVENT_MODE:
+        // Commande servo ou programme : même effet sur le contrôleur
+        *manual = r->value;
+        s->in.program = r->value ? PROG_CMD_RUN : PROG_CMD_STOP;
+        return 1;
+    case EVENT_BARRIER:
+        if (!*manual)
+            return 0;
+        s->in.program_angle = r->value;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Compare les sorties d'un type, dans l'ordre. Retourne 0 si elles divergent.
+static int compare(uint8_t type, const std::vector<record_t> &expected, const std::vector<record_t> &got,
+                   uint32_t from_ms, uint32_t until_ms)
+{
+    std::vector<const record_t *> a, b;
+
+    for (size_t i = 0; i < expected.size(); i++)
+        if (expected[i].type == type)
+            a.push_back(&expected[i]);
+    for (size_t i = 0; i < got.size(); i++)
+        if (got[i].type == type && got[i].ms + options.tolerance_ms >= from_ms && got[i].ms <= until_ms)
+            b.push_back(&got[i]);
+
+    for (size_t i = 0; i < a.size() || i < b.size(); i++)
+    {
+        const record_t *x = i < a.size() ? a[i] : NULL;
+        const record_t *y = i < b.size() ? b[i] : NULL;
+        long dt = x && y ? (long)y->ms - (long)x->ms : 0;
+
+        if (x && y && x->value == y->value && labs(dt) <= (long)options.tolerance_ms)
+            continue;
+
+        printf("%-8s : divergence à l'événement %zu\n", event_names[type], i + 1);
+        printf("  capture : ");
+        if (x) print_record(x); else printf("(rien)\n");
+        printf("  rejeu   : ");
+        if (y) print_record(y); else printf("(rien)\n");
+        return 0;
+    }
+    printf("%-8s : %zu événements identiques\n", event_names[type], a.size());
+    return 1;
+}
+
+static int replay_capture(const char *path)
+{
+    FILE *f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    char line[LINE_SIZE];
+    std::vector<record_t> capture, expected, replayed;
+
+    if (!f)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 2;
+    }
+    while (fgets(line, sizeof(line), f))
+    {
+        record_t r;
+        if (parse_line(line, &r))
+            capture.push_back(r);
+    }
+    if (f != stdin)
+        fclose(f);
+    if (capture.empty())
+    {
+        fprintf(stderr, "%s : aucun événement\n", path);
+        return 2;
+    }
+
+    // Le firmware journalise dans l'ordre, la FIFO est vidée par lots
+    uint32_t end = capture.back().ms + options.tolerance_ms;
+    replay_t s;
+    bool manual = false;
+    size_t next = 0;
+
+    replay_init(&s);
+    for (uint32_t now = 0; now <= end; now += SERVO_PERIOD_MS)
+    {
+        while (next < capture.size() && capture[next].ms <= now)
+        {
+            const record_t *r = &capture[next++];
+            if (replay_input(&s, r, &manual))
+            {
+                if (r->type == EVENT_CAR || r->type == EVENT_LIGHT)
+                    replayed.push_back(*r);
+            }
+            else if (r->type == EVENT_BARRIER || r->type == EVENT_LED)
+            {
+                expected.push_back(*r);
+            }
+        }
+
+        size_t first = replayed.size();
+        replay_step(&s, now, &replayed);
+
+        // Positions manuelles : rejouées, donc pas comparées
+        if (s.controller.is_manual())
+        {
+            for (size_t i = first; i < replayed.size(); i++)
+                if (replayed[i].type == EVENT_BARRIER)
+                    replayed[i].type = 0;
+        }
+    }
+
+    if (!options.quiet)
+    {
+        for (size_t i = 0; i < replayed.size(); i++)
+        {
+            record_t r = replayed[i];
+            if (r.type == 0)
+                r.type = EVENT_BARRIER;
+            print_record(&r);
+        }
+        printf("\n");
+    }
+
+    uint32_t from = capture.front().ms;
+    int ok = compare(EVENT_BARRIER, expected, replayed, from, end);
+    ok &= compare(EVENT_LED, expected, replayed, from, end);
+    return ok ? 0 : 1;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Arrivées et départs sur toutes les places, nuit/jour, et de temps en
+// temps une commande manuelle suivie d'un retour en automatique
+static int replay_synthetic(unsigned long steps)
+{
+    replay_t s;
+    uint32_t rng = options.seed ? options.seed : 1;
+    unsigned long events = 0;
+    std::vector<record_t> out;
+    struct timespec t0, t1;
+
+    replay_init(&s);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (unsigned long k = 0; k < steps; k++)
+    {
+        uint32_t now = (uint32_t)(k * SERVO_PERIOD_MS);
+        uint32_t r = xorshift32(&rng);
+
+        if ((r & 0x1F) == 0)
+        {
+            uint8_t spot = (r >> 5) % SPOT_COUNT;
+            s.occupancy ^= 1u << spot;
+            if (options.verbose)
+            {
+                record_t e = { now, EVENT_CAR, spot, (uint8_t)((s.occupancy >> spot) & 1) };
+                out.push_back(e);
+            }
+        }
+        if ((r >> 16) == 0)
+        {
+            s.dark = !s.dark;
+            if (options.verbose)
+            {
+                record_t e = { now, EVENT_LIGHT, 0, s.dark };
+                out.push_back(e);
+            }
+        }
+        if (((r >> 12) & 0x3FF) == 0)
+            s.in.servo_command = s.controller.is_manual() ? CONTROLLER_CMD_AUTO : 1 + (r >> 24) % 180;
+
+        events += replay_step(&s, now, options.verbose ? &out : NULL);
+
+        if (options.verbose)
+        {
+            for (size_t i = 0; i < out.size(); i++)
+                print_record(&out[i]);
+            out.clear();
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr, "%lu cycles (%.1f h simulées), %lu événements, %.3f s : %.2f M cycles/s\n",
+            steps, steps * (SERVO_PERIOD_MS / 3600000.0), events, seconds,
+            seconds > 0 ? steps / seconds / 1e6 : 0.0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *capture = NULL;
+    unsigned long synthetic = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "-q"))
+            options.quiet = true;
+        else if (!strcmp(arg, "-v"))
+            options.verbose = true;
+        else if (!strcmp(arg, "--hold-ms") && value)
+            options.hold_ms = (uint16_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--open-angle") && value)
+            options.open_angle = (uint8_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--tolerance") && value)
+            options.tolerance_ms = (uint32_t)atol(argv[++i]);
+        else if (!strcmp(arg, "--seed") && value)
+            options.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(arg, "--synthetic") && value)
+            synthetic = strtoul(argv[++i], NULL, 0);
+        else if (arg[0] != '-' || !strcmp(arg, "-"))
+            capture = arg;
+        else
+            capture = NULL, synthetic = 0, i = argc;
+    }
+
+    if (options.hold_ms < SERVO_PERIOD_MS || options.hold_ms > 12750 ||
+        options.open_angle < 1 || options.open_angle > 180)
+    {
+        fprintf(stderr, "--hold-ms 50-12750, --open-angle 1-180\n");
+        return 2;
+    }
+    if (synthetic)
+        return replay_synthetic(synthetic);
+    if (capture)
+        return replay_capture(capture);
+
+    fprintf(stderr, "usage: %s [--hold-ms MS] [--open-angle DEG] [--tolerance MS] [-q] capture.txt\n"
+                    "       %s [--seed S] [-v] --synthetic N\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,427 @@
+/*
+ * Simulateur de trafic : la logique de la barrière face à des arrivées
+ * synthétiques, en temps simulé sur la machine hôte.
+ *
+ * Le firmware est représenté par le code qu'exécutent ses tâches :
+ * ParkingController (drivers/parking_controller.h), la politique de maintien
+ * (hold_policy.c) et la pré-ouverture (preopen.c), compilés tels quels et
+ * appelés dans l'ordre de la tâche servo. Les capteurs IR sont échantillonnés
+ * toutes les ir_period_ms, la tâche servo et la tâche LEDs tournent toutes
+ * les SERVO_PERIOD_MS.
+ *
+ * Modèle de la voie d'entrée (place 0) :
+ *   - une voiture passe le capteur d'approche puis rejoint la file
+ *     APPROACH_MS plus tard ;
+ *   - la première de la file avance devant la barrière (capteur de la
+ *     place 0) HEADWAY_MS après le départ de la précédente ;
+ *   - elle attend que la barrière soit ouverte en grand (vitesse du servo :
+ *     servo_ms_per_deg), passe en PASS_MS puis se gare sur une place libre
+ *     (places 1 à SPOT_COUNT-1) pour une durée moyenne de dwell_min.
+ * Les arrivées sont un processus de Poisson (tirage par pas de TICK_MS), avec
+ * des fenêtres de pointe et des rafales selon le scénario. Un parasite
+ * inverse un échantillon d'un capteur pris au hasard.
+ *
+ * Pour chaque scénario et chaque politique de maintien :
+ *   voitures servies par heure, attente moyenne et p99 (arrivée dans la file
+ *   -> barrière ouverte devant elle), file maximale, cycles du servo
+ *   (ouvertures automatiques depuis la position fermée), événements de
+ *   changement signalés au master (REG_CHANGE_FLAG), part du temps où la
+ *   barrière n'est pas fermée.
+ *
+ * Tout est en arithmétique entière avec une graine fixe par scénario : la
+ * sortie est identique d'une machine à l'autre (make sim-check la compare à
+ * bench/traffic_sim.ref).
+ *
+ * Usage : traffic_sim [options] [scénario...]   (tous par défaut)
+ *   --policy fixed|adaptive|all   politique(s) simulée(s) (all)
+ *   --hours H                     durée de chaque scénario
+ *   --seed S                      graine (défaut : celle du scénario)
+ *   --list                        liste des scénarios
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+#include "parking_controller.h"
+#include "hold_policy.h"
+#include "preopen.h"
+#include "params.h"
+
+#ifndef SPOT_COUNT
+#define SPOT_COUNT          1
+#endif
+
+#define TICK_MS             10
+#define SERVO_PERIOD_MS     50
+#define APPROACH_MS         4000    // Capteur d'approche -> file
+#define APPROACH_PULSE_MS   500     // Durée de détection par le capteur d'approche
+#define HEADWAY_MS          1500    // Départ d'une voiture -> la suivante devant la barrière
+#define PASS_MS             2500    // Passage sous la barrière (capteur occupé)
+#define TICKS_PER_HOUR      (3600000UL / TICK_MS)
+
+typedef ParkingController<SPOT_COUNT> Controller;
+
+typedef struct
+{
+    const char *name;
+    uint32_t seed;
+    uint16_t hours;
+    uint16_t rate;              // Arrivées par heure hors pointe
+    uint16_t rush_start_min;    // Fenêtre de pointe, répétée chaque heure
+    uint16_t rush_length_min;
+    uint16_t rush_rate;
+    uint16_t burst_every_min;   // Rafale de burst_cars voitures, burst_gap_ms d'écart
+    uint8_t  burst_cars;
+    uint16_t burst_gap_ms;
+    uint16_t glitches;          // Parasites capteurs par heure
+    uint8_t  preopen_angle;     // Capteur d'approche (0 = absent)
+    uint16_t dwell_min;         // Durée moyenne de stationnement
+} scenario_t;
+
+static const scenario_t scenarios[] =
+{
+    // name       seed  h  rate  pointe (min, durée, /h)  rafales (min, n, ms)  parasites  préouv.  dwell
+    { "offpeak",  1,    8, 20,   0,  0,  0,               0,  0, 0,             0,         0,       60  },
+    { "rush",     2,    4, 30,   20, 20, 400,             0,  0, 0,             0,         0,       120 },
+    { "bursts",   3,    4, 10,   0,  0,  0,               15, 6, 2000,          0,         0,       45  },
+    { "queue",    4,    2, 30,   0,  15, 1200,            0,  0, 0,             0,         0,       90  },
+    { "glitch",   5,    8, 20,   0,  0,  0,               0,  0, 0,             30,        0,       60  },
+    { "preopen",  6,    4, 30,   20, 20, 400,             0,  0, 0,             0,         60,      120 },
+};
+#define SCENARIO_COUNT  (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const char *const policy_names[HOLD_POLICY_COUNT] = { "fixed", "adaptive" };
+
+// ------------ Paramètres (valeurs par défaut de params.h) ------------
+static uint16_t param_values[PARAM_COUNT];
+
+static void params_defaults(void)
+{
+#define PARAM_DEFAULT(id, type, min, max, def)  param_values[id] = def;
+    PARAM_TABLE(PARAM_DEFAULT)
+#undef PARAM_DEFAULT
+}
+
+extern "C" uint16_t params_get(uint8_t id)
+{
+    return id < PARAM_COUNT ? param_values[id] : 0;
+}
+
+// ------------ Aléa déterministe ------------
+static uint32_t rng;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Vrai avec une probabilité `per_hour` / TICKS_PER_HOUR
+static bool chance(uint32_t per_hour)
+{
+    return per_hour && xorshift32() < (uint32_t)(((uint64_t)per_hour << 32) / TICKS_PER_HOUR);
+}
+
+typedef struct
+{
+    uint32_t served;
+    uint32_t queue_max;
+    uint32_t barrier_cycles;
+    uint32_t change_events;
+    uint32_t open_ticks;
+    uint32_t left_in_queue;
+    std::vector<uint32_t> waits;    // ms
+} result_t;
+
+static void simulate(const scenario_t *sc, uint8_t policy, uint32_t seed, uint16_t hours, result_t *res)
+{
+    Controller controller;
+    ControllerInputs in;
+    ControllerOutputs out;
+    std::vector<uint32_t> approaching, queue;   // Instants de passage au capteur d'approche / d'arrivée dans la file
+    uint32_t parked_until[SPOT_COUNT] = { 0 };  // 0 = place libre
+    uint16_t physical = 0, sensed = 0;
+    uint16_t glitch = 0;
+    uint32_t lane_last_change = 0;
+    uint8_t  prev_lane_car = 0, led_state = 0xFF;
+    uint32_t barrier_mdeg = 0;                  // Position réelle (millidegrés)
+    uint32_t approach_until = 0;
+    uint32_t next_burst = sc->burst_every_min * 60000UL;
+    uint8_t  burst_left = 0;
+    uint32_t burst_next_ms = 0;
+
+    // Voiture devant la barrière
+    enum { LANE_EMPTY, LANE_WAITING, LANE_PASSING } lane = LANE_EMPTY;
+    uint32_t lane_until = 0, lane_queued_ms = 0, lane_free_at = 0;
+
+    params_defaults();
+    hold_policy_reset();
+    preopen_reset();
+    param_values[PARAM_HOLD_POLICY] = policy;
+    param_values[PARAM_PREOPEN_ANGLE] = sc->preopen_angle;
+    rng = seed ? seed : 1;
+    in.servo_command = CONTROLLER_CMD_NONE;
+    in.program = 0;
+    in.program_angle = CONTROLLER_NO_MOVE;
+
+    const uint32_t end_ms = hours * 3600000UL;
+    const uint16_t ir_period = params_get(PARAM_IR_PERIOD_MS);
+    const uint32_t open_mdeg = params_get(PARAM_OPEN_ANGLE) * 1000UL;
+    const uint32_t mdeg_per_tick = TICK_MS * 1000UL / params_get(PARAM_SERVO_MS_PER_DEG);
+
+    for (uint32_t now = 0; now < end_ms; now += TICK_MS)
+    {
+        // 1. Arrivées au capteur d'approche
+        uint32_t minute = now / 60000 % 60;
+        bool rush = minute >= sc->rush_start_min && minute < sc->rush_start_min + sc->rush_length_min;
+        uint32_t arrivals = chance(rush ? sc->rush_rate : sc->rate);
+
+        if (sc->burst_every_min && now >= next_burst)
+        {
+            next_burst += sc->burst_every_min * 60000UL;
+            burst_left = sc->burst_cars;
+            burst_next_ms = now;
+        }
+        if (burst_left && now >= burst_next_ms)
+        {
+            burst_left--;
+            burst_next_ms = now + sc->burst_gap_ms;
+            arrivals++;
+        }
+        while (arrivals--)
+        {
+            approaching.push_back(now);
+            approach_until = now + APPROACH_PULSE_MS;
+        }
+        while (!approaching.empty() && now - approaching.front() >= APPROACH_MS)
+        {
+            queue.push_back(approaching.front() + APPROACH_MS);
+            approaching.erase(approaching.begin());
+        }
+        if (queue.size() > res->queue_max)
+            res->queue_max = queue.size();
+
+        // 2. Voie de la barrière
+        if (lane == LANE_EMPTY && !queue.empty() && now >= lane_free_at)
+        {
+            lane = LANE_WAITING;
+            lane_queued_ms = queue.front();
+            queue.erase(queue.begin());
+            physical |= 1;
+        }
+        if (lane == LANE_WAITING && barrier_mdeg >= open_mdeg)
+        {
+            res->waits.push_back(now - lane_queued_ms);
+            lane = LANE_PASSING;
+            lane_until = now + PASS_MS;
+        }
+        if (lane == LANE_PASSING && now >= lane_until)
+        {
+            lane = LANE_EMPTY;
+            lane_free_at = now + HEADWAY_MS;
+            physical &= ~1u;
+            res->served++;
+
+            // Première place libre, sinon la voiture repart par la sortie
+            for (uint8_t n = 1; n < SPOT_COUNT; n++)
+            {
+                if (parked_until[n])
+                    continue;
+                // Durée uniforme entre 1 et 2 x dwell_min - 1 minutes
+                uint32_t dwell = 60000UL + (uint64_t)xorshift32() * 2 * (sc->dwell_min - 1) * 60000UL / UINT32_MAX;
+                parked_until[n] = now + dwell;
+                physical |= 1u << n;
+                break;
+            }
+        }
+        for (uint8_t n = 1; n < SPOT_COUNT; n++)
+        {
+            if (parked_until[n] && now >= parked_until[n])
+            {
+                parked_until[n] = 0;
+                physical &= ~(1u << n);
+            }
+        }
+
+        if (chance(sc->glitches))
+            glitch ^= 1u << (xorshift32() % SPOT_COUNT);
+
+        // 3. Tâche IR : un échantillon, un événement par place qui change
+        if (now % ir_period == 0)
+        {
+            uint16_t sample = physical ^ glitch;
+            glitch = 0;
+            for (uint8_t n = 0; n < SPOT_COUNT; n++)
+            {
+                if (((sample ^ sensed) >> n) & 1)
+                {
+                    res->change_events++;
+                    if (n == 0)
+                        lane_last_change = now;
+                }
+            }
+            sensed = sample;
+        }
+
+        // 4. Tâche servo, dans l'ordre du firmware
+        if (now % SERVO_PERIOD_MS == 0)
+        {
+            uint8_t lane_car = sensed & 1;
+            if (lane_car && !prev_lane_car)
+            {
+                hold_policy_arrival(policy, lane_last_change);
+                preopen_car_arrived(lane_last_change);
+            }
+            else if (!lane_car && prev_lane_car)
+            {
+                preopen_car_left(lane_last_change);
+            }
+            prev_lane_car = lane_car;
+
+            in.occupancy = sensed;
+            in.lane_hold = hold_policy_update(policy, now) / SERVO_PERIOD_MS;
+            in.spot_hold = params_get(PARAM_BARRIER_HOLD_MS) / SERVO_PERIOD_MS;
+            in.open_angle = params_get(PARAM_OPEN_ANGLE);
+            in.preopen_angle = preopen_update(now < approach_until, lane_car, now);
+
+            controller.step(in, now, out);
+            if (out.barrier_cycle)
+            {
+                hold_policy_barrier_cycle(policy);
+                res->barrier_cycles++;
+            }
+            preopen_barrier(out.servo_units / SERVO_UNITS_PER_DEG, now);
+            res->change_events += out.event_count;
+
+            // Tâche LEDs (même période par défaut)
+            uint8_t leds = Controller::leds(false, lane_car, controller.released(0));
+            if (leds != led_state)
+            {
+                led_state = leds;
+                res->change_events++;
+            }
+        }
+
+        // 5. Mouvement réel de la barrière
+        uint32_t target = (uint32_t)(controller.servo() / SERVO_UNITS_PER_DEG) * 1000;
+        if (barrier_mdeg < target)
+            barrier_mdeg = std::min(target, barrier_mdeg + mdeg_per_tick);
+        else if (barrier_mdeg > target)
+            barrier_mdeg = barrier_mdeg > target + mdeg_per_tick ? barrier_mdeg - mdeg_per_tick : target;
+        if (barrier_mdeg)
+            res->open_ticks++;
+    }
+
+    res->left_in_queue = queue.size() + approaching.size() + (lane != LANE_EMPTY);
+}
+
+static void report(const scenario_t *sc, uint8_t policy, uint16_t hours, result_t *res)
+{
+    std::vector<uint32_t> &w = res->waits;
+    uint64_t sum = 0;
+    uint32_t p99 = 0;
+
+    std::sort(w.begin(), w.end());
+    for (size_t i = 0; i < w.size(); i++)
+        sum += w[i];
+    if (!w.empty())
+        p99 = w[(w.size() * 99 + 99) / 100 - 1];
+
+    uint32_t mean = w.empty() ? 0 : (uint32_t)(sum / w.size());
+    uint32_t ticks = hours * TICKS_PER_HOUR;
+
+    printf("%-8s %-8s %8lu %7lu.%02lu %7lu.%02lu %5lu %7lu %8lu %5lu.%lu %6lu\n",
+           sc->name, policy_names[policy],
+           (unsigned long)(res->served / hours),
+           (unsigned long)(mean / 1000), (unsigned long)(mean % 1000 / 10),
+           (unsigned long)(p99 / 1000), (unsigned long)(p99 % 1000 / 10),
+           (unsigned long)res->queue_max,
+           (unsigned long)res->barrier_cycles,
+           (unsigned long)res->change_events,
+           (unsigned long)((uint64_t)res->open_ticks * 100 / ticks),
+           (unsigned long)((uint64_t)res->open_ticks * 1000 / ticks % 10),
+           (unsigned long)res->left_in_queue);
+}
+
+int main(int argc, char *argv[])
+{
+    const scenario_t *selected[SCENARIO_COUNT];
+    unsigned count = 0;
+    int policy = -1;
+    uint16_t hours = 0;
+    uint32_t seed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--list"))
+        {
+            for (unsigned s = 0; s < SCENARIO_COUNT; s++)
+                printf("%s\n", scenarios[s].name);
+            return 0;
+        }
+        else if (!strcmp(arg, "--policy") && value)
+        {
+            i++;
+            policy = !strcmp(value, "fixed") ? HOLD_POLICY_FIXED :
+                     !strcmp(value, "adaptive") ? HOLD_POLICY_ADAPTIVE :
+                     !strcmp(value, "all") ? -1 : -2;
+        }
+        else if (!strcmp(arg, "--hours") && value)
+            hours = (uint16_t)atoi(argv[++i]);
+        else if (!strcmp(arg, "--seed") && value)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (arg[0] != '-' && count < SCENARIO_COUNT)
+        {
+            unsigned s = 0;
+            while (s < SCENARIO_COUNT && strcmp(arg, scenarios[s].name))
+                s++;
+            if (s == SCENARIO_COUNT)
+            {
+                fprintf(stderr, "unknown scenario %s (--list)\n", arg);
+                return 2;
+            }
+            selected[count++] = &scenarios[s];
+        }
+        else
+            policy = -2, i = argc;
+    }
+    if (policy == -2)
+    {
+        fprintf(stderr, "usage: %s [--policy fixed|adaptive|all] [--hours H] [--seed S] [--list] [scenario...]\n",
+                argv[0]);
+        return 2;
+    }
+    if (!count)
+    {
+        for (unsigned s = 0; s < SCENARIO_COUNT; s++)
+            selected[count++] = &scenarios[s];
+    }
+
+    printf("SPOT_COUNT=%u\n", SPOT_COUNT);
+    printf("%-8s %-8s %8s %10s %10s %5s %7s %8s %7s %6s\n",
+           "scénario", "maintien", "voit./h", "att. moy s", "att. p99 s", "file", "cycles", "événem.", "ouv. %", "reste");
+
+    for (unsigned s = 0; s < count; s++)
+    {
+        for (uint8_t p = 0; p < HOLD_POLICY_COUNT; p++)
+        {
+            if (policy >= 0 && p != policy)
+                continue;
+
+            result_t res = {};
+            uint16_t h = hours ? hours : selected[s]->hours;
+            simulate(selected[s], p, seed ? seed : selected[s]->seed, h, &res);
+            report(selected[s], p, h, &res);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,269 @@
+/*
+ * Benchmark du bus I2C en mode rapide sous simavr : le programme joue le
+ * maître (la Raspberry Pi) et enchaîne sans pause des transactions typiques
+ * de i2c_master.py, puis mesure pour chaque octet l'étirement d'horloge de
+ * l'esclave, c'est-à-dire le temps entre la fin de l'octet sur le bus et la
+ * réponse du firmware (ISR TWI, callbacks et latence d'interruption compris).
+ *
+ * simavr cadence les octets d'après TWBR : le firmware doit être compilé
+ * avec I2C_FREQ égal à BUS_HZ (400 kHz par défaut dans le Makefile).
+ *
+ * Le contrôleur I2C de la Pi abandonne la transaction si SCL reste tenu bas
+ * plus de 64 périodes (registre CLKT, 160 µs à 400 kHz) : le benchmark
+ * échoue si le pire étirement dépasse STRETCH_LIMIT_US.
+ *
+ * Usage : twi_stretch Build/ParkingRTOS.elf [durée_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_irq.h"
+#include "avr_twi.h"
+
+#define SLAVE_ADDRESS       0x32
+#define F_CPU               16000000UL
+#define BUS_HZ              400000UL
+#define STRETCH_LIMIT_US    (64 * 1000000UL / BUS_HZ)
+#define WARMUP_MS           500     // Démarrage des tâches, non mesuré
+#define TIMEOUT_US          2000    // Pas de réponse : transaction abandonnée
+
+#define US_TO_CYCLES(us)    ((avr_cycle_count_t)(us) * (F_CPU / 1000000UL))
+#define BYTE_CYCLES         (9 * F_CPU / BUS_HZ)    // 8 bits + ACK
+
+// Transactions rejouées en boucle : registre écrit puis octets lus
+// (0 = écriture seule de `value` dans `reg`)
+typedef struct
+{
+    const char *name;
+    uint8_t reg;
+    uint8_t value;
+    uint8_t read;
+} transaction_t;
+
+static const transaction_t script[] =
+{
+    { "status (1 octet)",     5,    0, 1  },
+    { "uptime (rafale 8)",    16,   0, 8  },
+    { "banque (rafale 32)",   0,    0, 32 },
+    { "FIFO événements (32)", 24,   0, 32 },
+    { "sélection de page",    0xFF, 0, 0  },
+};
+#define SCRIPT_LENGTH   (sizeof(script) / sizeof(script[0]))
+
+enum master_state {
+    M_IDLE,
+    M_WAIT_ADDR_W_ACK,
+    M_WAIT_REG_ACK,
+    M_WAIT_VALUE_ACK,
+    M_WAIT_ADDR_R_ACK,
+    M_WAIT_DATA,
+};
+
+typedef struct
+{
+    unsigned long done;
+    unsigned long aborted;
+    avr_cycle_count_t stretch_max;
+    avr_cycle_count_t stretch_total;
+    unsigned long bytes;
+} result_t;
+
+static avr_t *avr;
+static avr_irq_t *twi_in;
+static enum master_state state = M_IDLE;
+static avr_cycle_count_t request_cycle;
+static avr_cycle_count_t start_cycle;
+static unsigned current = 0;
+static uint8_t remaining = 0;
+static result_t results[SCRIPT_LENGTH];
+
+static void master_send(uint8_t msg, uint8_t addr, uint8_t data)
+{
+    request_cycle = avr->cycle;
+    avr_raise_irq(twi_in, avr_twi_irq_msg(msg, addr, data));
+}
+
+static void master_stop(void)
+{
+    avr_raise_irq(twi_in, avr_twi_irq_msg(TWI_COND_STOP, SLAVE_ADDRESS << 1, 0));
+    state = M_IDLE;
+}
+
+// Au-delà du temps de l'octet lui-même, le bus est tenu par l'esclave
+static void account_byte(void)
+{
+    result_t *r = &results[current];
+    avr_cycle_count_t elapsed = avr->cycle - request_cycle;
+    avr_cycle_count_t stretch = elapsed > BYTE_CYCLES ? elapsed - BYTE_CYCLES : 0;
+
+    if (avr->cycle < start_cycle)
+        return;
+    if (stretch > r->stretch_max)
+        r->stretch_max = stretch;
+    r->stretch_total += stretch;
+    r->bytes++;
+}
+
+static void transaction_done(void)
+{
+    if (avr->cycle >= start_cycle)
+        results[current].done++;
+    master_stop();
+    current = (current + 1) % SCRIPT_LENGTH;
+}
+
+static void read_next(void)
+{
+    remaining--;
+    state = M_WAIT_DATA;
+    master_send(TWI_COND_READ | (remaining ? TWI_COND_ACK : 0), (SLAVE_ADDRESS << 1) | 1, 0);
+}
+
+static void twi_output_hook(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    avr_twi_msg_irq_t v = { .u.v = value };
+    const transaction_t *t = &script[current];
+    int acked = (v.u.twi.msg & TWI_COND_ACK) && v.u.twi.data;
+
+    switch (state)
+    {
+    case M_WAIT_ADDR_W_ACK:
+        if (!acked)
+            break;
+        account_byte();
+        state = M_WAIT_REG_ACK;
+        master_send(TWI_COND_WRITE, SLAVE_ADDRESS << 1, t->reg);
+        break;
+
+    case M_WAIT_REG_ACK:
+        if (!acked)
+            break;
+        account_byte();
+        if (!t->read)
+        {
+            state = M_WAIT_VALUE_ACK;
+            master_send(TWI_COND_WRITE, SLAVE_ADDRESS << 1, t->value);
+            break;
+        }
+        state = M_WAIT_ADDR_R_ACK;
+        master_send(TWI_COND_START, (SLAVE_ADDRESS << 1) | 1, 0);
+        break;
+
+    case M_WAIT_VALUE_ACK:
+        if (!acked)
+            break;
+        account_byte();
+        transaction_done();
+        break;
+
+    case M_WAIT_ADDR_R_ACK:
+        if (!acked)
+            break;
+        account_byte();
+        remaining = t->read;
+        read_next();
+        break;
+
+    case M_WAIT_DATA:
+        if (!(v.u.twi.msg & TWI_COND_READ))
+            break;
+        account_byte();
+        if (remaining)
+            read_next();
+        else
+            transaction_done();
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Enchaîne les transactions ; abandonne celle en cours si l'esclave ne répond plus
+static avr_cycle_count_t master_poll(avr_t *a, avr_cycle_count_t when, void *param)
+{
+    if (state != M_IDLE && a->cycle - request_cycle > US_TO_CYCLES(TIMEOUT_US))
+    {
+        if (a->cycle >= start_cycle)
+            results[current].aborted++;
+        master_stop();
+        current = (current + 1) % SCRIPT_LENGTH;
+    }
+
+    if (state == M_IDLE)
+    {
+        state = M_WAIT_ADDR_W_ACK;
+        master_send(TWI_COND_START, SLAVE_ADDRESS << 1, 0);
+    }
+
+    return when + BYTE_CYCLES;
+}
+
+static double cycles_to_us(avr_cycle_count_t c)
+{
+    return (double)c * 1000000.0 / F_CPU;
+}
+
+int main(int argc, char *argv[])
+{
+    elf_firmware_t firmware = {{0}};
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s firmware.elf [duration_ms]\n", argv[0]);
+        return 2;
+    }
+    unsigned duration_ms = argc > 2 ? (unsigned)atoi(argv[2]) : 2000;
+
+    if (elf_read_firmware(argv[1], &firmware) != 0)
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 2;
+    }
+
+    avr = avr_make_mcu_by_name("atmega328p");
+    if (!avr)
+    {
+        fprintf(stderr, "simavr: atmega328p not supported\n");
+        return 2;
+    }
+    avr_init(avr);
+    avr->frequency = F_CPU;
+    avr_load_firmware(avr, &firmware);
+
+    twi_in = avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+                            twi_output_hook, NULL);
+    avr_cycle_timer_register(avr, US_TO_CYCLES(WARMUP_MS * 1000UL), master_poll, NULL);
+
+    start_cycle = US_TO_CYCLES(WARMUP_MS * 1000UL);
+    avr_cycle_count_t deadline = start_cycle + US_TO_CYCLES(duration_ms * 1000UL);
+    int cpu_state = cpu_Running;
+    while (avr->cycle < deadline && cpu_state != cpu_Done && cpu_state != cpu_Crashed)
+        cpu_state = avr_run(avr);
+
+    avr_cycle_count_t worst = 0;
+    unsigned long aborted = 0;
+    printf("bus %lu kHz, %u ms mesurées, limite d'étirement %lu us\n",
+           BUS_HZ / 1000, duration_ms, STRETCH_LIMIT_US);
+    printf("%-22s %10s %8s %10s %10s\n", "transaction", "tx/s", "abandon", "étir. moy", "étir. max");
+    for (unsigned i = 0; i < SCRIPT_LENGTH; i++)
+    {
+        result_t *r = &results[i];
+        printf("%-22s %10.0f %8lu %8.1f us %8.1f us\n", script[i].name,
+               r->done * 1000.0 / duration_ms, r->aborted,
+               r->bytes ? cycles_to_us(r->stretch_total) / r->bytes : 0.0,
+               cycles_to_us(r->stretch_max));
+        if (r->stretch_max > worst)
+            worst = r->stretch_max;
+        aborted += r->aborted;
+    }
+
+    avr_terminate(avr);
+    return (cpu_state != cpu_Crashed && !aborted &&
+            cycles_to_us(worst) <= STRETCH_LIMIT_US) ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+#include "barrier_prog.h"
+
+#define STEP_BUDGET     16          // Instructions par appel : une boucle sans attente ne bloque pas la tâche
+#define VALID           0xFF
+
+static volatile prog_slot_t slot;
+
+static uint8_t  loop_armed = 0;     // Compteur de PROG_LOOP en cours (pas d'imbrication)
+static uint8_t  waiting = 0;        // PROG_WAIT en cours
+static uint32_t wait_until_ms = 0;
+static uint32_t ref_ms = 0;         // Fin de la dernière attente : les attentes successives ne dérivent pas
+
+volatile prog_slot_t *prog_slot(void)
+{
+    return &slot;
+}
+
+static uint8_t insn_length(uint8_t op)
+{
+    switch (op)
+    {
+    case PROG_END:
+    case PROG_AUTO:     return 1;
+    case PROG_MOVE:
+    case PROG_WAIT_CAR: return 2;
+    case PROG_WAIT:
+    case PROG_LOOP:     return 3;
+    default:            return 0;
+    }
+}
+
+// Vérifie le programme avant de toucher à la barrière. Retourne VALID ou
+// l'adresse de la première instruction fautive.
+static uint8_t validate(void)
+{
+    uint32_t starts = 0;            // Débuts d'instructions, cibles possibles de PROG_LOOP
+    uint8_t loop_end = 0;           // Une boucle ne peut pas englober la précédente
+    uint8_t pc = 0;
+
+    while (pc < PROG_CODE_SIZE)
+    {
+        uint8_t op = slot.code[pc];
+        uint8_t len = insn_length(op);
+
+        if (!len || pc + len > PROG_CODE_SIZE)
+            return pc;
+        if (op == PROG_MOVE && slot.code[pc + 1] > 180)
+            return pc;
+        if (op == PROG_WAIT_CAR && slot.code[pc + 1] > 1)
+            return pc;
+        if (op == PROG_LOOP)
+        {
+            uint8_t target = slot.code[pc + 1];
+            if (target < loop_end || target >= pc || !(starts & (1UL << target)))
+                return pc;
+            loop_end = pc + len;
+        }
+        if (op == PROG_END || op == PROG_AUTO)
+            return VALID;
+
+        starts |= 1UL << pc;
+        pc += len;
+    }
+    return pc;                      // Pas de fin de programme
+}
+
+uint8_t prog_poll_command(uint32_t now_ms)
+{
+    uint8_t cmd = slot.ctrl;
+
+    if (cmd == 0)
+        return 0;
+    slot.ctrl = 0;
+
+    if (cmd == PROG_CMD_RUN)
+    {
+        uint8_t fault = validate();
+        if (fault != VALID)
+        {
+            slot.pc = fault;
+            slot.status = PROG_ERROR;
+            return 0;
+        }
+        slot.pc = 0;
+        slot.loops_left = 0;
+        loop_armed = 0;
+        waiting = 0;
+        ref_ms = now_ms;
+        slot.status = PROG_RUNNING;
+        return PROG_CMD_RUN;
+    }
+
+    if (cmd == PROG_CMD_STOP)
+    {
+        prog_stop();
+        return PROG_CMD_STOP;
+    }
+    return 0;
+}
+
+void prog_stop(void)
+{
+    if (slot.status == PROG_RUNNING)
+        slot.status = PROG_STOPPED;
+}
+
+uint8_t prog_running(void)
+{
+    return slot.status == PROG_RUNNING;
+}
+
+uint16_t prog_step(uint8_t lane_car, uint32_t now_ms, uint8_t *angle_deg, uint8_t *auto_mode)
+{
+    uint8_t budget = STEP_BUDGET;
+
+    *angle_deg = PROG_NO_MOVE;
+
+    while (slot.status == PROG_RUNNING)
+    {
+        if (!budget--)
+            return 1;
+
+        // Le master a pu réécrire le code pendant l'exécution
+        uint8_t pc = slot.pc;
+        uint8_t op = pc < PROG_CODE_SIZE ? slot.code[pc] : 0xFF;
+        uint8_t len = insn_length(op);
+        if (!len || pc + len > PROG_CODE_SIZE)
+        {
+            slot.status = PROG_ERROR;
+            break;
+        }
+        volatile uint8_t *arg = &slot.code[pc + 1];
+
+        switch (op)
+        {
+        case PROG_MOVE:
+            *angle_deg = arg[0] > 180 ? 180 : arg[0];
+            break;
+
+        case PROG_WAIT:
+            if (!waiting)
+            {
+                waiting = 1;
+                wait_until_ms = ref_ms + (arg[0] | ((uint16_t)arg[1] << 8));
+            }
+            if ((int32_t)(wait_until_ms - now_ms) > 0)
+                return wait_until_ms - now_ms;
+            waiting = 0;
+            ref_ms = wait_until_ms;
+            break;
+
+        case PROG_WAIT_CAR:
+            if (lane_car != arg[0])
+                return PROG_POLL;
+            ref_ms = now_ms;
+            break;
+
+        case PROG_LOOP:
+            if (arg[1] == 0)
+            {
+                len = 0;
+                pc = arg[0];
+                break;
+            }
+            if (!loop_armed)
+            {
+                loop_armed = 1;
+                slot.loops_left = arg[1];
+            }
+            if (slot.loops_left)
+            {
+                slot.loops_left--;
+                len = 0;
+                pc = arg[0];
+            }
+            else
+            {
+                loop_armed = 0;
+            }
+            break;
+
+        case PROG_AUTO:
+            *auto_mode = 1;
+            slot.status = PROG_DONE;
+            break;
+
+        default:    // PROG_END
+            slot.status = PROG_DONE;
+            break;
+        }
+
+        slot.pc = pc + len;
+    }
+    return PROG_POLL;
+}
@@ -0,0 +1,76 @@
+#ifndef BARRIER_PROG_H
+#define BARRIER_PROG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Séquences de la barrière chargées par le master dans la page I2C
+// "program" puis exécutées par la tâche servo, sans échange sur le bus
+// pendant l'exécution. Instructions (arguments 16 bits en little-endian) :
+//   PROG_END                 fin, la barrière reste où elle est (mode manuel)
+//   PROG_MOVE   angle        barrière à `angle` degrés (0-180)
+//   PROG_WAIT   ms(16)       attente, à la milliseconde près
+//   PROG_WAIT_CAR  état      attente voiture présente (1) / partie (0) à la barrière
+//   PROG_LOOP   cible n      retour à l'octet `cible` du code, n fois (0 = sans fin)
+//   PROG_AUTO                fin, retour au mode automatique
+// Exemple, ouvrir 30 s puis reprendre le mode auto :
+//   PROG_MOVE 120, PROG_WAIT 0x30 0x75, PROG_AUTO
+
+#define PROG_END            0x00
+#define PROG_MOVE           0x01
+#define PROG_WAIT           0x02
+#define PROG_WAIT_CAR       0x03
+#define PROG_LOOP           0x04
+#define PROG_AUTO           0x05
+
+#define PROG_CODE_SIZE      28
+
+// Commandes (champ ctrl, remis à 0 une fois prises en compte)
+#define PROG_CMD_RUN        1       // Vérifie puis lance le programme
+#define PROG_CMD_STOP       2       // Arrête et revient au mode automatique
+
+// Etat (champ status)
+#define PROG_IDLE           0
+#define PROG_RUNNING        1
+#define PROG_DONE           2       // Terminé par PROG_END ou PROG_AUTO
+#define PROG_STOPPED        3       // Arrêté par le master (commande ou servo manuel)
+#define PROG_ERROR          0x80    // Programme invalide, pc = instruction fautive
+
+// Page I2C "program" (32 octets, le master écrit ctrl et code)
+typedef struct
+{
+    uint8_t ctrl;
+    uint8_t status;
+    uint8_t pc;
+    uint8_t loops_left;
+    uint8_t code[PROG_CODE_SIZE];
+} prog_slot_t;
+
+volatile prog_slot_t *prog_slot(void);
+
+// Résultat de prog_step()
+#define PROG_NO_MOVE        0xFF    // *angle_deg : barrière inchangée
+#define PROG_POLL           0xFFFF  // Attente d'un capteur : rappeler au prochain cycle
+
+// Traite la commande du master. Retourne PROG_CMD_RUN / PROG_CMD_STOP si
+// un programme vient d'être lancé ou arrêté, 0 sinon.
+uint8_t  prog_poll_command(uint32_t now_ms);
+
+// Arrêt demandé par une commande servo manuelle
+void     prog_stop(void);
+
+uint8_t  prog_running(void);
+
+// Exécute les instructions échues. *angle_deg reçoit la dernière position
+// demandée ; retourne le délai (ms) jusqu'à la prochaine échéance.
+// *auto_mode passe à 1 si le programme se termine par PROG_AUTO.
+uint16_t prog_step(uint8_t lane_car, uint32_t now_ms, uint8_t *angle_deg, uint8_t *auto_mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+#include "event_log.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "soft_i2c.h"
+
+#define BATCH_HEADER_SIZE   3
+#define BATCH_MAX_EVENTS    ((32 - BATCH_HEADER_SIZE) / sizeof(event_t))   // 4
+#define BATCH_MORE          0x80
+
+#if (EVENT_LOG_SIZE & (EVENT_LOG_SIZE - 1)) != 0
+#error "EVENT_LOG_SIZE doit être une puissance de 2"
+#endif
+
+static event_t events[EVENT_LOG_SIZE];
+static volatile uint8_t head = 0;       // Prochaine écriture (tâches)
+static volatile uint8_t tail = 0;       // Plus ancien enregistrement non acquitté (ISR I2C)
+static volatile uint8_t lost = 0;
+
+void event_log_push(uint32_t timestamp, uint8_t type, uint8_t value)
+{
+    taskENTER_CRITICAL();
+
+    if ((uint8_t)(head - tail) >= EVENT_LOG_SIZE)
+    {
+        lost++;
+    }
+    else
+    {
+        event_t *e = &events[head & (EVENT_LOG_SIZE - 1)];
+        e->timestamp = timestamp;
+        e->type = type;
+        e->value = value;
+        head++;
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+// Appelé depuis requestEvent() (ISR TWI, interruptions masquées)
+void event_log_send_batch(uint8_t ack)
+{
+    // Les numéros sont les compteurs head/tail eux-mêmes
+    if ((uint8_t)(ack - tail) <= (uint8_t)(head - tail))
+        tail = ack;
+
+    uint8_t pending = head - tail;
+    uint8_t count = pending > BATCH_MAX_EVENTS ? BATCH_MAX_EVENTS : pending;
+    uint8_t header[BATCH_HEADER_SIZE];
+
+    header[0] = count | (pending > count ? BATCH_MORE : 0);
+    header[1] = lost;
+    header[2] = tail;
+    soft_i2c_write(header, sizeof(header));
+
+    for (uint8_t i = 0; i < count; i++)
+        soft_i2c_write((const uint8_t *)&events[(uint8_t)(tail + i) & (EVENT_LOG_SIZE - 1)], sizeof(event_t));
+}
@@ -0,0 +1,49 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Journal des transitions en RAM (FIFO circulaire), vidé par le master I2C.
+
+#define EVENT_LOG_SIZE      16      // Nombre d'enregistrements (puissance de 2)
+
+// Types d'événements
+#define EVENT_CAR           1       // value = voiture détectée (0/1)
+#define EVENT_LIGHT         2       // value = sombre (0/1)
+#define EVENT_BARRIER       3       // value = angle de la barrière (degrés)
+#define EVENT_LED           4       // value = état des LEDs (bit0=R, bit1=G, bit2=W)
+#define EVENT_MODE          5       // value = 1 manuel, 0 automatique
+#define EVENT_DIRECTION     6       // value = TRAFFIC_ENTER ou TRAFFIC_EXIT (voir traffic.h)
+
+// Enregistrement tel qu'envoyé sur le bus (6 octets, little-endian)
+typedef struct
+{
+    uint32_t timestamp;             // Uptime en ms (sysmon_uptime_ms)
+    uint8_t  type;
+    uint8_t  value;
+} event_t;
+
+// Ajoute un événement ; si la FIFO est pleine il est perdu et compté
+void event_log_push(uint32_t timestamp, uint8_t type, uint8_t value);
+
+// Envoie un lot au master (appelé par le callback du registre flux) :
+//   octet 0 : bits 0-6 = nombre d'enregistrements du lot, bit 7 = il en reste
+//   octet 1 : compteur d'événements perdus (modulo 256)
+//   octet 2 : numéro (modulo 256) du premier enregistrement du lot
+//   puis jusqu'à 4 enregistrements de 6 octets
+// `ack` est le numéro du prochain enregistrement attendu par le master,
+// écrit par lui après chaque lot reçu en entier : les enregistrements
+// précédents sont retirés de la FIFO avant l'envoi. Sans acquittement (lecture
+// en erreur), le même lot est renvoyé ; un acquittement déjà appliqué ou hors
+// de la FIFO est ignoré.
+void event_log_send_batch(uint8_t ack);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+#include "hold_policy.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "params.h"
+
+#define GAP_AVG_SHIFT   2           // Moyenne exponentielle sur ~4 arrivées
+#define GAP_UNKNOWN     0xFFFFFFFF
+
+static volatile hold_stats_t stats;
+
+static uint8_t  seen_arrival = 0;
+static uint32_t last_arrival_ms = 0;
+static uint32_t avg_gap_ms = GAP_UNKNOWN;
+static uint32_t last_gap_ms = GAP_UNKNOWN;
+static uint32_t last_update_ms = 0;
+static uint32_t active_ms[HOLD_POLICY_COUNT];
+
+volatile hold_stats_t *hold_policy_stats(void)
+{
+    return &stats;
+}
+
+uint16_t hold_policy_update(uint8_t policy, uint32_t now_ms)
+{
+    uint16_t hold;
+
+    if (policy == HOLD_POLICY_ADAPTIVE)
+    {
+        // Heure de pointe : les deux dernières arrivées sont rapprochées (ou
+        // la moyenne l'est), et la dernière est assez récente pour qu'une
+        // autre voiture soit attendue. Le dernier écart seul suffit : après
+        // une longue période creuse, la moyenne met plusieurs arrivées à
+        // redescendre et une rafale serait servie avec le maintien court.
+        uint16_t rush_gap = params_get(PARAM_RUSH_GAP_MS);
+        uint32_t recent_gap = last_gap_ms < avg_gap_ms ? last_gap_ms : avg_gap_ms;
+        uint8_t rush = recent_gap < rush_gap && now_ms - last_arrival_ms < rush_gap;
+        hold = params_get(rush ? PARAM_RUSH_HOLD_MS : PARAM_SHORT_HOLD_MS);
+    }
+    else
+    {
+        hold = params_get(PARAM_BARRIER_HOLD_MS);
+    }
+
+    active_ms[policy] += now_ms - last_update_ms;
+    last_update_ms = now_ms;
+
+    taskENTER_CRITICAL();
+    while (active_ms[policy] >= 60000UL)
+    {
+        active_ms[policy] -= 60000UL;
+        stats.active_min[policy]++;
+    }
+    stats.hold_ms = hold;
+    taskEXIT_CRITICAL();
+
+    return hold;
+}
+
+void hold_policy_arrival(uint8_t policy, uint32_t now_ms)
+{
+    // Les moyennes sont suivies quelle que soit la politique active : on peut
+    // basculer en adaptatif sans période d'apprentissage.
+    if (seen_arrival)
+    {
+        uint32_t gap = now_ms - last_arrival_ms;
+        last_gap_ms = gap;
+        if (avg_gap_ms == GAP_UNKNOWN)
+            avg_gap_ms = gap;
+        else
+            avg_gap_ms = avg_gap_ms - (avg_gap_ms >> GAP_AVG_SHIFT) + (gap >> GAP_AVG_SHIFT);
+    }
+    last_arrival_ms = now_ms;
+    seen_arrival = 1;
+
+    taskENTER_CRITICAL();
+    stats.cars_served[policy]++;
+    stats.avg_gap_s = avg_gap_ms == GAP_UNKNOWN ? 0xFFFF :
+                      avg_gap_ms / 1000 > 0xFFFF ? 0xFFFF : avg_gap_ms / 1000;
+    taskEXIT_CRITICAL();
+}
+
+void hold_policy_barrier_cycle(uint8_t policy)
+{
+    taskENTER_CRITICAL();
+    stats.barrier_cycles[policy]++;
+    taskEXIT_CRITICAL();
+}
+
+void hold_policy_reset(void)
+{
+    seen_arrival = 0;
+    last_arrival_ms = 0;
+    avg_gap_ms = GAP_UNKNOWN;
+    last_gap_ms = GAP_UNKNOWN;
+    last_update_ms = 0;
+    memset(active_ms, 0, sizeof(active_ms));
+
+    taskENTER_CRITICAL();
+    memset((void *)&stats, 0, sizeof(stats));
+    taskEXIT_CRITICAL();
+}
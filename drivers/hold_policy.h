@@ -0,0 +1,47 @@
+#ifndef HOLD_POLICY_H
+#define HOLD_POLICY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Politique de maintien de la barrière ouverte après le départ d'une voiture.
+//   FIXED    : barrier_hold_ms, quel que soit le trafic
+//   ADAPTIVE : tant que les voitures arrivent plus vite que rush_gap_ms
+//              (dernier écart ou moyenne), la barrière reste ouverte
+//              rush_hold_ms (file d'attente : pas de fermeture entre deux
+//              voitures) ; sinon elle se referme après short_hold_ms.
+
+#define HOLD_POLICY_FIXED       0
+#define HOLD_POLICY_ADAPTIVE    1
+#define HOLD_POLICY_COUNT       2
+
+// Compteurs par politique (page I2C "policy"), little-endian
+typedef struct
+{
+    uint16_t cars_served[HOLD_POLICY_COUNT];    // Arrivées à la barrière
+    uint16_t barrier_cycles[HOLD_POLICY_COUNT]; // Ouvertures automatiques
+    uint16_t active_min[HOLD_POLICY_COUNT];     // Minutes passées sous chaque politique
+    uint16_t avg_gap_s;                         // Temps moyen entre deux arrivées (s)
+    uint16_t hold_ms;                           // Maintien appliqué actuellement
+} hold_stats_t;
+
+volatile hold_stats_t *hold_policy_stats(void);
+
+// À appeler à chaque cycle de la tâche servo : compte le temps passé sous
+// `policy` et retourne le maintien à appliquer (ms)
+uint16_t hold_policy_update(uint8_t policy, uint32_t now_ms);
+
+void     hold_policy_arrival(uint8_t policy, uint32_t now_ms);
+void     hold_policy_barrier_cycle(uint8_t policy);
+
+// Revient à l'état du démarrage, compteurs compris (simulateur de trafic)
+void     hold_policy_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,17 @@
+#include "ir.h"
+#include "pin.h"
+
+typedef Pin<PortB, PB0> IrPin;   // Arduino D8
+
+void ir_init(void)
+{
+    IrPin::pullup();          // INPUT + pull-up (optional but recommended)
+}
+
+uint8_t ir_detect(void)
+{
+    // FC-51 outputs:
+    //   LOW  -> obstacle detected
+    //   HIGH -> no obstacle
+    return IrPin::read() ? 0 : 1;
+}
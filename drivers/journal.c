@@ -0,0 +1,154 @@
+#include "journal.h"
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "soft_i2c.h"
+
+#define RECORD_SIZE         sizeof(journal_record_t)
+#define SLOT_COUNT          ((JOURNAL_EEPROM_END - JOURNAL_EEPROM_BASE) / RECORD_SIZE)  // 120
+#define BATCH_MAX_RECORDS   3
+#define BATCH_MORE          0x80
+
+static uint8_t  head = 0;           // Prochain slot à écrire
+static uint8_t  count = 0;          // Slots valides
+static uint16_t next_seq = 0;
+static uint8_t  boot = 0;
+
+// Curseur de relecture, avancé par l'ISR I2C
+static volatile uint8_t read_slot = 0;
+static volatile uint8_t read_remaining = 0;
+
+static uint8_t *slot_address(uint8_t slot)
+{
+    return (uint8_t *)(JOURNAL_EEPROM_BASE + (uint16_t)slot * RECORD_SIZE);
+}
+
+static uint8_t record_crc(const journal_record_t *r)
+{
+    const uint8_t *bytes = (const uint8_t *)r;
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < RECORD_SIZE - 1; i++)
+        crc = _crc8_ccitt_update(crc, bytes[i]);
+    return crc;
+}
+
+void journal_init(void)
+{
+    journal_record_t r;
+    uint8_t found = 0;
+    uint8_t newest = 0;
+    uint16_t newest_seq = 0;
+
+    count = 0;
+    for (uint8_t slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        eeprom_read_block(&r, slot_address(slot), RECORD_SIZE);
+        if (r.crc != record_crc(&r))
+            continue;   // Slot effacé ou écriture interrompue
+
+        count++;
+        // Comparaison modulo 2^16 : le plus récent a le seq le plus grand
+        if (!found || (int16_t)(r.seq - newest_seq) > 0)
+        {
+            found = 1;
+            newest = slot;
+            newest_seq = r.seq;
+            boot = r.boot;
+        }
+    }
+
+    if (found)
+    {
+        head = (newest + 1) % SLOT_COUNT;
+        next_seq = newest_seq + 1;
+        boot++;
+    }
+
+    journal_rewind();
+}
+
+void journal_append(uint32_t uptime_ms, uint8_t state)
+{
+    journal_record_t r;
+    uint32_t time_s = uptime_ms / 1000;
+
+    r.seq = next_seq;
+    r.boot = boot;
+    r.time_s[0] = time_s;
+    r.time_s[1] = time_s >> 8;
+    r.time_s[2] = time_s >> 16;
+    r.state = state;
+    r.crc = record_crc(&r);
+
+    // Ecriture octet par octet sans attente active : la tâche est bloquée
+    // pendant que l'EEPROM programme l'octet précédent.
+    uint8_t *dst = slot_address(head);
+    const uint8_t *src = (const uint8_t *)&r;
+    for (uint8_t i = 0; i < RECORD_SIZE; i++)
+    {
+        while (!eeprom_is_ready())
+            vTaskDelay(1);
+
+        taskENTER_CRITICAL();   // Pas de lecture EEPROM par l'ISR I2C entre-temps
+        eeprom_update_byte(dst + i, src[i]);
+        taskEXIT_CRITICAL();
+    }
+
+    taskENTER_CRITICAL();
+    head = (head + 1) % SLOT_COUNT;
+    if (count < SLOT_COUNT)
+        count++;
+    next_seq++;
+    taskEXIT_CRITICAL();
+}
+
+uint8_t journal_count(void)
+{
+    return count;
+}
+
+uint8_t journal_boot(void)
+{
+    return boot;
+}
+
+void journal_rewind(void)
+{
+    taskENTER_CRITICAL();
+    // Anneau plein : le plus ancien est juste après la tête
+    read_slot = count < SLOT_COUNT ? (head + SLOT_COUNT - count) % SLOT_COUNT : head;
+    read_remaining = count;
+    taskEXIT_CRITICAL();
+}
+
+// Appelé depuis requestEvent() (ISR TWI, interruptions masquées)
+void journal_send_batch(void)
+{
+    journal_record_t r;
+
+    // Ne jamais attendre la fin d'une écriture EEPROM sous interruption
+    if (!eeprom_is_ready())
+    {
+        uint8_t header = read_remaining ? BATCH_MORE : 0;
+        soft_i2c_write(&header, 1);
+        return;
+    }
+
+    uint8_t n = read_remaining > BATCH_MAX_RECORDS ? BATCH_MAX_RECORDS : read_remaining;
+    uint8_t header = n | (read_remaining > n ? BATCH_MORE : 0);
+    soft_i2c_write(&header, 1);
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        eeprom_read_block(&r, slot_address(read_slot), RECORD_SIZE);
+        soft_i2c_write((const uint8_t *)&r, RECORD_SIZE);
+        read_slot = (read_slot + 1) % SLOT_COUNT;
+        read_remaining--;
+    }
+}
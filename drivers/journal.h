@@ -0,0 +1,58 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Journal persistant en EEPROM : enregistrements de 8 octets protégés par
+// CRC-8, écrits en anneau sur toute la zone pour répartir l'usure.
+
+#define JOURNAL_EEPROM_BASE 0x040   // 64 premiers octets réservés à la configuration
+#define JOURNAL_EEPROM_END  (E2END + 1)
+
+// Bits de l'état journalisé
+#define JOURNAL_CAR         0x01
+#define JOURNAL_DARK        0x02
+#define JOURNAL_BARRIER     0x04    // Barrière ouverte
+#define JOURNAL_MANUAL      0x08
+#define JOURNAL_LED_RED     0x10
+#define JOURNAL_LED_GREEN   0x20
+#define JOURNAL_LED_WHITE   0x40
+
+typedef struct
+{
+    uint16_t seq;                   // Numéro de séquence (continu entre les boots)
+    uint8_t  boot;                  // Numéro de boot (modulo 256)
+    uint8_t  time_s[3];             // Uptime en secondes, 24 bits little-endian
+    uint8_t  state;                 // Bits JOURNAL_*
+    uint8_t  crc;                   // CRC-8 (poly 0x07) des 7 octets précédents
+} journal_record_t;
+
+// Retrouve la tête du journal (à appeler depuis une tâche)
+void    journal_init(void);
+
+// Ajoute un enregistrement. Rend la main au scheduler pendant chaque écriture
+// d'octet (~3,4 ms) : à appeler depuis une tâche de basse priorité.
+void    journal_append(uint32_t uptime_ms, uint8_t state);
+
+uint8_t journal_count(void);        // Enregistrements valides
+uint8_t journal_boot(void);         // Numéro du boot courant
+
+// Relecture par le master : journal_rewind() replace le curseur sur le plus
+// ancien enregistrement, journal_send_batch() (à enregistrer avec
+// soft_i2c_on_stream) envoie un lot :
+//   octet 0 : bits 0-6 = nombre d'enregistrements, bit 7 = il en reste
+//   puis jusqu'à 3 enregistrements de 8 octets
+// Si l'EEPROM est en cours d'écriture, le lot est vide avec le bit 7 à 1.
+void    journal_rewind(void);
+void    journal_send_batch(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,13 +3,15 @@
 #include <avr/io.h>
 #include <util/delay.h>
 
+#include "pin.h"
+
 // ----------------------------
 // Pins (Arduino UNO / ATmega328P)
 // SDA = A4 = PC4
 // SCL = A5 = PC5
 // ----------------------------
-#define SDA_BIT PC4
-#define SCL_BIT PC5
+typedef Pin<PortC, PC4> Sda;
+typedef Pin<PortC, PC5> Scl;
 
 // Grove LCD I2C address
 #define LCD_ADDR 0x3E
@@ -49,27 +51,25 @@ static void i2c_delay(void)
 static void sda_release(void)
 {
     // input + pull-up = logical HIGH (lines are open-drain)
-    DDRC &= ~(1 << SDA_BIT);
-    PORTC |= (1 << SDA_BIT);
+    Sda::pullup();
 }
 
 static void sda_low(void)
 {
     // drive low
-    DDRC |= (1 << SDA_BIT);
-    PORTC &= ~(1 << SDA_BIT);
+    Sda::output();
+    Sda::low();
 }
 
 static void scl_release(void)
 {
-    DDRC &= ~(1 << SCL_BIT);
-    PORTC |= (1 << SCL_BIT);
+    Scl::pullup();
 }
 
 static void scl_low(void)
 {
-    DDRC |= (1 << SCL_BIT);
-    PORTC &= ~(1 << SCL_BIT);
+    Scl::output();
+    Scl::low();
 }
 
 static void i2c_start(void)
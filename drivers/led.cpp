@@ -0,0 +1,16 @@
+#include "led.h"
+#include "pin.h"
+
+typedef Pin<PortD, PD2> LedPin;
+
+void led_init(void) {
+    LedPin::output();
+}
+
+void led_set(uint8_t state) {
+    LedPin::set(state);
+}
+
+void led_toggle(void) {
+    LedPin::toggle();
+}
@@ -0,0 +1,126 @@
+#include "occupancy.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "soft_i2c.h"
+
+#define MINUTE_MS       60000UL
+
+_Static_assert(sizeof(occupancy_stats_t) <= 32, "une rafale I2C fait 32 octets au plus");
+
+static volatile occupancy_stats_t stats = { .generation = 1 };
+static occupancy_stats_t sent;              // Dernière rafale envoyée
+static volatile occupancy_reset_t reset_request;
+
+// Taux d'occupation : places occupées cumulées sur la tranche en cours,
+// puis taux de chaque tranche terminée
+static uint32_t bucket_start_ms = 0;
+static uint32_t bucket_sum = 0;
+static uint16_t bucket_samples = 0;
+static uint8_t  buckets[OCCUPANCY_BUCKETS];
+static uint8_t  bucket_next = 0;
+static uint8_t  bucket_filled = 0;
+
+// Interruptions masquées. Seule la rafale acquittée est retranchée, et
+// seulement si aucune lecture ne l'a remplacée depuis : appliquée aussi
+// avant chaque rafale. Une demande déjà appliquée nomme une génération
+// passée et ne correspond plus.
+static void apply_reset(void)
+{
+    if (reset_request.generation != stats.generation ||
+        reset_request.generation != sent.generation ||
+        reset_request.sequence != sent.sequence)
+        return;
+
+    stats.entries -= sent.entries;
+    for (uint8_t i = 0; i < OCCUPANCY_BINS; i++)
+        stats.dwell_hist[i] -= sent.dwell_hist[i];
+    stats.generation++;
+}
+
+static uint8_t dwell_bin(uint32_t dwell_ms)
+{
+    uint32_t minutes = dwell_ms / MINUTE_MS;
+    uint8_t bin = 0;
+
+    while (minutes && bin < OCCUPANCY_BINS - 1)
+    {
+        minutes >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void occupancy_arrival(void)
+{
+    taskENTER_CRITICAL();
+    stats.entries++;
+    taskEXIT_CRITICAL();
+}
+
+void occupancy_departure(uint32_t dwell_ms)
+{
+    uint8_t bin = dwell_bin(dwell_ms);
+
+    taskENTER_CRITICAL();
+    stats.dwell_hist[bin]++;
+    taskEXIT_CRITICAL();
+}
+
+void occupancy_update(uint8_t occupied, uint8_t spot_count, uint32_t longest_dwell_ms,
+                      uint32_t now_ms)
+{
+    uint32_t longest_s = longest_dwell_ms / 1000;
+
+    bucket_sum += occupied;
+    bucket_samples++;
+
+    if (now_ms - bucket_start_ms >= OCCUPANCY_BUCKET_MS)
+    {
+        buckets[bucket_next] = bucket_sum * 100 / ((uint32_t)bucket_samples * spot_count);
+        bucket_next = (bucket_next + 1) % OCCUPANCY_BUCKETS;
+        if (bucket_filled < OCCUPANCY_BUCKETS)
+            bucket_filled++;
+
+        uint16_t total = 0;
+        for (uint8_t i = 0; i < bucket_filled; i++)
+            total += buckets[i];
+        stats.utilisation_pct = total / bucket_filled;
+
+        bucket_start_ms = now_ms;
+        bucket_sum = 0;
+        bucket_samples = 0;
+    }
+
+    taskENTER_CRITICAL();
+    stats.longest_dwell_s = longest_s > 0xFFFF ? 0xFFFF : longest_s;
+    apply_reset();
+    taskEXIT_CRITICAL();
+}
+
+// Appelé depuis requestEvent() (ISR TWI, interruptions masquées)
+void occupancy_send(void)
+{
+    uint8_t sequence = sent.sequence + 1;
+    uint8_t sum = 0;
+
+    apply_reset();
+    memcpy(&sent, (const void *)&stats, sizeof(sent));
+    sent.sequence = sequence;
+    sent.checksum = 0;
+
+    // Une somme plutôt qu'un CRC-8 : quelques µs pour 32 octets, dans l'ISR
+    for (uint8_t i = 0; i < sizeof(sent); i++)
+        sum += ((const uint8_t *)&sent)[i];
+    sent.checksum = -sum;
+
+    soft_i2c_write((const uint8_t *)&sent, sizeof(sent));
+}
+
+volatile occupancy_reset_t *occupancy_reset_slot(void)
+{
+    return &reset_request;
+}
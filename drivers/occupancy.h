@@ -0,0 +1,66 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Statistiques d'occupation calculées sur place, à chaque cycle de la tâche
+// IR : le master n'a plus besoin de suivre les places en continu, une
+// lecture par minute suffit.
+//
+// Histogramme des durées de stationnement, en classes logarithmiques :
+//   classe 0 : moins d'une minute
+//   classe k : de 2^(k-1) à 2^k - 1 minutes (1, 2-3, 4-7, ...)
+//   dernière : 1024 minutes (~17 h) et plus
+
+#define OCCUPANCY_BINS          12
+#define OCCUPANCY_BUCKET_MS     240000UL    // Taux d'occupation : tranches de 4 min
+#define OCCUPANCY_BUCKETS       15          // ... sur une heure glissante
+
+// Page I2C "occupancy" (32 octets, little-endian)
+typedef struct
+{
+    uint16_t entries;                       // Arrivées, toutes places confondues
+    uint8_t  sequence;                      // +1 à chaque rafale envoyée
+    uint8_t  checksum;                      // La somme des 32 octets vaut 0 (modulo 256)
+    uint16_t longest_dwell_s;               // Plus long stationnement en cours (s)
+    uint8_t  utilisation_pct;               // Taux d'occupation sur l'heure écoulée
+    uint8_t  generation;                    // Période de comptage, +1 à chaque remise à zéro
+    uint16_t dwell_hist[OCCUPANCY_BINS];    // Son total est le nombre de départs
+} occupancy_stats_t;
+
+// Page I2C "occupancy reset" (écriture)
+typedef struct
+{
+    uint8_t  sequence;                      // Rafale vérifiée par le master
+    uint8_t  generation;
+} occupancy_reset_t;
+
+void occupancy_arrival(void);
+void occupancy_departure(uint32_t dwell_ms);
+
+// À chaque cycle : places occupées parmi `spot_count` et plus long
+// stationnement en cours. Applique aussi la remise à zéro demandée.
+void occupancy_update(uint8_t occupied, uint8_t spot_count, uint32_t longest_dwell_ms,
+                      uint32_t now_ms);
+
+// Envoie les statistiques en une rafale de 32 octets (à enregistrer avec
+// soft_i2c_add_stream_page) et en garde une copie.
+void occupancy_send(void);
+
+// Remise à zéro (à enregistrer en écriture avec soft_i2c_add_page) : le
+// master y écrit, en une transaction, la séquence et la génération de la
+// dernière rafale qu'il a reçue intacte. Si c'est bien la dernière rafale
+// envoyée, à lui ou à un autre lecteur, ses arrivées et son histogramme sont
+// retranchés des compteurs et la génération avance. Sinon rien n'est remis
+// à zéro : les événements que le master n'a pas reçus ne sont jamais perdus.
+volatile occupancy_reset_t *occupancy_reset_slot(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
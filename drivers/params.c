@@ -0,0 +1,219 @@
+#include "params.h"
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Chaque copie (32 octets) contient :
+ *   octet 0 : BANK_MAGIC (change si le format change)
+ *   octet 1 : numéro de séquence, incrémenté à chaque sauvegarde
+ *   octet 2 : nombre de paramètres enregistrés
+ *   puis les valeurs dans l'ordre des identifiants (1 ou 2 octets selon le
+ *   type, little-endian) et un CRC-8 (poly 0x07) de tout ce qui précède.
+ * Les paramètres ajoutés depuis la sauvegarde prennent leur valeur par
+ * défaut, les autres sont conservés à la mise à jour du firmware.
+ * Une sauvegarde écrit toujours la copie qui ne contient pas les valeurs en
+ * vigueur ; au démarrage on charge la copie valide la plus récente.
+ */
+
+#define BANK_SIZE       (PARAMS_EEPROM_SIZE / 2)
+#define BANK_MAGIC      0xA6
+#define BANK_HEADER     3
+#define BANK_MAGIC_V1   0xA5    // Premier format : pas d'octet 2, 6 paramètres
+#define BANK_V1_COUNT   6
+
+_Static_assert(BANK_HEADER + 2 * PARAM_COUNT + 1 <= BANK_SIZE, "trop de paramètres pour une copie EEPROM");
+
+typedef struct
+{
+    uint8_t  type;
+    uint16_t min;
+    uint16_t max;
+    uint16_t def;
+} param_info_t;
+
+#define PARAM_INFO(id, type, min, max, def)     [id] = { type, min, max, def },
+
+static const param_info_t info[PARAM_COUNT] PROGMEM = { PARAM_TABLE(PARAM_INFO) };
+
+static volatile uint16_t live[PARAM_COUNT];    // Valeurs en vigueur (lues par l'ISR I2C)
+static uint16_t          staged[PARAM_COUNT];  // Modifiées par le master, appliquées par params_commit()
+static uint8_t           bank = 0;             // Copie EEPROM des valeurs en vigueur
+static uint8_t           seq = 0;
+
+static uint8_t *bank_address(uint8_t b)
+{
+    return (uint8_t *)(PARAMS_EEPROM_BASE + (uint16_t)b * BANK_SIZE);
+}
+
+static uint8_t param_type(uint8_t id)
+{
+    return pgm_read_byte(&info[id].type);
+}
+
+static uint16_t param_default(uint8_t id)
+{
+    return pgm_read_word(&info[id].def);
+}
+
+static uint8_t param_valid(uint8_t id, uint16_t value)
+{
+    param_info_t p;
+
+    memcpy_P(&p, &info[id], sizeof(p));
+    return value >= p.min && value <= p.max;
+}
+
+// Décode une copie lue en EEPROM, retourne 0 si elle est invalide
+static uint8_t bank_decode(const uint8_t *buf, uint16_t *values)
+{
+    uint8_t n, stored;
+    uint8_t crc = 0;
+
+    if (buf[0] == BANK_MAGIC)
+    {
+        n = BANK_HEADER;
+        stored = buf[2];
+    }
+    else if (buf[0] == BANK_MAGIC_V1)
+    {
+        n = BANK_HEADER - 1;
+        stored = BANK_V1_COUNT;
+    }
+    else
+    {
+        return 0;
+    }
+
+    // Sauvegarde d'un firmware plus récent : tailles inconnues
+    if (stored > PARAM_COUNT)
+        return 0;
+
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+    {
+        if (id >= stored)
+        {
+            values[id] = param_default(id);
+            continue;
+        }
+        values[id] = buf[n++];
+        if (param_type(id) == PARAM_U16)
+            values[id] |= (uint16_t)buf[n++] << 8;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
+        crc = _crc8_ccitt_update(crc, buf[i]);
+    return buf[n] == crc;
+}
+
+void params_load(void)
+{
+    uint8_t buf[BANK_SIZE];
+    uint16_t values[PARAM_COUNT];
+    uint8_t found = 0;
+
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+        live[id] = param_default(id);
+
+    for (uint8_t b = 0; b < 2; b++)
+    {
+        eeprom_read_block(buf, bank_address(b), BANK_SIZE);
+        if (!bank_decode(buf, values))
+            continue;   // Jamais écrite ou sauvegarde interrompue
+
+        // Comparaison modulo 256 : la plus récente a le seq le plus grand
+        if (found && (int8_t)(buf[1] - seq) <= 0)
+            continue;
+
+        found = 1;
+        bank = b;
+        seq = buf[1];
+        for (uint8_t id = 0; id < PARAM_COUNT; id++)
+            live[id] = param_valid(id, values[id]) ? values[id] : param_default(id);
+    }
+
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+        staged[id] = live[id];
+}
+
+volatile uint16_t *params_values(void)
+{
+    return live;
+}
+
+uint16_t params_get(uint8_t id)
+{
+    uint16_t value = 0;
+
+    if (id < PARAM_COUNT)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            value = live[id];
+        }
+    }
+    return value;
+}
+
+uint8_t params_stage(uint8_t id, uint16_t value)
+{
+    if (id >= PARAM_COUNT || !param_valid(id, value))
+        return 0;
+
+    staged[id] = value;
+    return 1;
+}
+
+void params_stage_defaults(void)
+{
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+        staged[id] = param_default(id);
+}
+
+// Même principe que journal_append() : la tâche est bloquée pendant que
+// l'EEPROM programme l'octet précédent.
+static void save_byte(uint8_t *dst, uint8_t value, uint8_t *crc)
+{
+    while (!eeprom_is_ready())
+        vTaskDelay(1);
+
+    taskENTER_CRITICAL();   // Pas de lecture EEPROM par l'ISR I2C entre-temps
+    eeprom_update_byte(dst, value);
+    taskEXIT_CRITICAL();
+
+    *crc = _crc8_ccitt_update(*crc, value);
+}
+
+void params_commit(void)
+{
+    uint8_t target = bank ^ 1;
+    uint8_t *dst = bank_address(target);
+    uint8_t crc = 0;
+
+    // Les tâches voient toutes les nouvelles valeurs en même temps
+    taskENTER_CRITICAL();
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+        live[id] = staged[id];
+    taskEXIT_CRITICAL();
+
+    save_byte(dst++, BANK_MAGIC, &crc);
+    save_byte(dst++, seq + 1, &crc);
+    save_byte(dst++, PARAM_COUNT, &crc);
+    for (uint8_t id = 0; id < PARAM_COUNT; id++)
+    {
+        save_byte(dst++, staged[id] & 0xFF, &crc);
+        if (param_type(id) == PARAM_U16)
+            save_byte(dst++, staged[id] >> 8, &crc);
+    }
+    save_byte(dst, crc, &crc);
+
+    bank = target;
+    seq++;
+}
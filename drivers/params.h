@@ -0,0 +1,83 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Paramètres réglables à chaud, sauvegardés en EEPROM (0x000-0x03F).
+// Deux copies sont alternées : une coupure pendant la sauvegarde laisse
+// toujours la précédente intacte (voir params.c).
+
+#define PARAMS_EEPROM_BASE      0x000
+#define PARAMS_EEPROM_SIZE      0x040   // Avant JOURNAL_EEPROM_BASE
+
+// Identifiants
+#define PARAM_BARRIER_HOLD_MS   0       // Maintien ouvert après le départ (ms, 50-12750)
+#define PARAM_OPEN_ANGLE        1       // Angle d'ouverture de la barrière (degrés, 1-180)
+#define PARAM_IR_PERIOD_MS      2       // Période de la tâche IR (ms)
+#define PARAM_LIGHT_PERIOD_MS   3       // Période de la tâche luminosité (ms)
+#define PARAM_LED_PERIOD_MS     4       // Période de la tâche LEDs (ms)
+#define PARAM_I2C_ADDRESS       5       // Adresse esclave, prise en compte au prochain démarrage
+#define PARAM_HOLD_POLICY       6       // Politique de maintien au démarrage (voir hold_policy.h)
+#define PARAM_RUSH_GAP_MS       7       // Adaptatif : écart entre arrivées en dessous duquel c'est l'heure de pointe
+#define PARAM_RUSH_HOLD_MS      8       // Adaptatif : maintien à l'heure de pointe (ms)
+#define PARAM_SHORT_HOLD_MS     9       // Adaptatif : maintien hors heure de pointe (ms)
+#define PARAM_BEAM_SPACING_MM   10      // Ecart entre les deux faisceaux d'entrée (voir traffic.h)
+#define PARAM_PREOPEN_ANGLE     11      // Angle de pré-ouverture (degrés, 0 = pas de capteur d'approche, voir preopen.h)
+#define PARAM_PREOPEN_TIMEOUT_MS 12     // Refermeture si aucune voiture n'atteint la barrière (ms)
+#define PARAM_SERVO_MS_PER_DEG  13      // Vitesse estimée de la barrière (ms par degré)
+#define PARAM_COUNT             14
+
+// Types
+#define PARAM_U8                1
+#define PARAM_U16               2
+
+// Type, bornes et valeur par défaut de chaque paramètre, X(id, type, min,
+// max, défaut) : params.c en tire sa table en flash, le simulateur de trafic
+// (bench/traffic_sim.cpp) ses valeurs de départ.
+// Les périodes restent sous 250 ms : chaque tâche doit se signaler au
+// superviseur à chacun de ses cycles.
+#define PARAM_TABLE(X) \
+    X(PARAM_BARRIER_HOLD_MS,    PARAM_U16, 50,   12750, 5000)  \
+    X(PARAM_OPEN_ANGLE,         PARAM_U8,  1,    180,   120)   \
+    X(PARAM_IR_PERIOD_MS,       PARAM_U8,  10,   200,   80)    \
+    X(PARAM_LIGHT_PERIOD_MS,    PARAM_U8,  10,   200,   100)   \
+    X(PARAM_LED_PERIOD_MS,      PARAM_U8,  10,   200,   50)    \
+    X(PARAM_I2C_ADDRESS,        PARAM_U8,  0x08, 0x77,  0x32)  \
+    X(PARAM_HOLD_POLICY,        PARAM_U8,  0,    1,     0)     \
+    X(PARAM_RUSH_GAP_MS,        PARAM_U16, 1000, 60000, 20000) \
+    X(PARAM_RUSH_HOLD_MS,       PARAM_U16, 50,   12750, 10000) \
+    X(PARAM_SHORT_HOLD_MS,      PARAM_U16, 50,   12750, 2500)  \
+    X(PARAM_BEAM_SPACING_MM,    PARAM_U16, 50,   2000,  300)   \
+    X(PARAM_PREOPEN_ANGLE,      PARAM_U8,  0,    180,   0)     \
+    X(PARAM_PREOPEN_TIMEOUT_MS, PARAM_U16, 500,  60000, 8000)  \
+    X(PARAM_SERVO_MS_PER_DEG,   PARAM_U8,  1,    50,    3)
+
+// Charge les valeurs sauvegardées (valeurs par défaut si aucune copie valide)
+void     params_load(void);
+
+// Valeur en vigueur (utilisable en tâche comme sous interruption)
+uint16_t params_get(uint8_t id);
+
+// Tableau des valeurs en vigueur (PARAM_COUNT x 16 bits little-endian),
+// servi tel quel par la page I2C "config"
+volatile uint16_t *params_values(void);
+
+// Prépare une nouvelle valeur sans l'appliquer. Retourne 0 si l'identifiant
+// est inconnu ou la valeur hors bornes.
+uint8_t  params_stage(uint8_t id, uint16_t value);
+void     params_stage_defaults(void);
+
+// Applique d'un coup toutes les valeurs préparées puis les sauvegarde.
+// Rend la main au scheduler pendant les écritures EEPROM : à appeler depuis
+// la tâche qui possède déjà l'EEPROM (tâche journal).
+void     params_commit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef PARKING_CONTROLLER_H
+#define PARKING_CONTROLLER_H
+
+#include <stdint.h>
+
+#include "event_log.h"
+#include "barrier_prog.h"
+
+/*
+ * Logique de décision du parking, sans accès aux broches, au bus ni au
+ * noyau : commandes servo du master, mode manuel/automatique, compteurs de
+ * libération des places, consigne automatique de la barrière et table de
+ * vérité des LEDs. Un appel de step() par cycle de la tâche servo
+ * (SERVO_PERIOD_MS) ; les capteurs et les modules à état propre (politique de
+ * maintien, pré-ouverture, programme de la barrière) sont lus par la tâche
+ * et passés en entrée.
+ *
+ * Même code sur l'AVR et sur la machine hôte (bench/replay.cpp rejoue des
+ * captures d'événements à plusieurs millions de cycles par seconde).
+ */
+
+#define SERVO_UNITS_PER_DEG     9       // Unités de servo_set_angle() par degré
+
+// ControllerInputs::servo_command
+#define CONTROLLER_CMD_NONE     0
+#define CONTROLLER_CMD_AUTO     255     // 1-180 : angle manuel
+
+// ControllerInputs::program_angle
+#define CONTROLLER_NO_MOVE      PROG_NO_MOVE
+
+// Bits de ParkingController::leds() (registre REG_LED_STATE)
+#define CONTROLLER_LED_RED      0x01
+#define CONTROLLER_LED_GREEN    0x02
+#define CONTROLLER_LED_WHITE    0x04
+
+typedef struct
+{
+    uint16_t occupancy;         // Bit n = place n occupée
+    uint8_t  servo_command;     // REG_SERVO_COMMAND
+    uint8_t  program;           // PROG_CMD_RUN / PROG_CMD_STOP (prog_poll_command, fin du programme), 0 sinon
+    uint8_t  program_angle;     // Dernière position donnée par le programme ce cycle (degrés)
+    uint8_t  lane_hold;         // Maintien de la voie de la barrière (cycles)
+    uint8_t  spot_hold;         // Maintien des autres places (cycles)
+    uint8_t  open_angle;        // Degrés
+    uint8_t  preopen_angle;     // Pré-ouverture demandée (degrés, 0 = aucune)
+} ControllerInputs;
+
+typedef struct
+{
+    uint16_t servo_units;       // Consigne du servo (0-1620)
+    uint8_t  free_spots;        // Places libres depuis au moins leur maintien
+    uint8_t  command_done;      // servo_command pris en compte : remettre le registre à 0
+    uint8_t  barrier_cycle;     // Ouverture automatique depuis la position fermée
+    uint8_t  event_count;
+    event_t  events[2];         // EVENT_MODE puis EVENT_BARRIER, horodatés now_ms
+} ControllerOutputs;
+
+template <uint8_t Spots>
+class ParkingController
+{
+public:
+    ParkingController() : servo_units(0), manual(false), reported_manual(false), reported_units(0xFFFF)
+    {
+        for (uint8_t n = 0; n < Spots; n++)
+            counter[n] = released_flags[n] = 0;
+    }
+
+    // Commande servo valide : arrête aussi le programme de la barrière
+    static bool is_servo_command(uint8_t command)
+    {
+        return command == CONTROLLER_CMD_AUTO || (command != CONTROLLER_CMD_NONE && command <= 180);
+    }
+
+    // Mode que step() retiendra pour ces commandes (la pré-ouverture n'est
+    // évaluée qu'en automatique)
+    bool manual_after(uint8_t servo_command, uint8_t program) const
+    {
+        bool next = manual;
+
+        if (servo_command == CONTROLLER_CMD_AUTO)
+            next = false;
+        else if (is_servo_command(servo_command))
+            next = true;
+        if (program == PROG_CMD_RUN)
+            next = true;
+        else if (program == PROG_CMD_STOP)
+            next = false;
+        return next;
+    }
+
+    void step(const ControllerInputs &in, uint32_t now_ms, ControllerOutputs &out)
+    {
+        out.command_done = is_servo_command(in.servo_command);
+        out.barrier_cycle = 0;
+        out.event_count = 0;
+
+        // 1. Commandes du master et du programme
+        if (out.command_done && in.servo_command != CONTROLLER_CMD_AUTO)
+            servo_units = in.servo_command * SERVO_UNITS_PER_DEG;
+        if (in.program_angle != CONTROLLER_NO_MOVE)
+            servo_units = in.program_angle * SERVO_UNITS_PER_DEG;
+        manual = manual_after(in.servo_command, in.program);
+
+        // 2. Compteurs de libération, en manuel comme en automatique pour
+        // garder les LEDs cohérentes. Une fois libérée, une place le reste
+        // même si un maintien plus long est appliqué entre-temps.
+        out.free_spots = 0;
+        for (uint8_t n = 0; n < Spots; n++)
+        {
+            uint8_t hold = n == 0 ? in.lane_hold : in.spot_hold;
+            if (in.occupancy & (1u << n))
+            {
+                counter[n] = 0;
+                released_flags[n] = 0;
+            }
+            else
+            {
+                if (counter[n] < hold)
+                    counter[n]++;
+                if (counter[n] >= hold)
+                    released_flags[n] = 1;
+            }
+            out.free_spots += released_flags[n];
+        }
+
+        // 3. Barrière en automatique (place 0 = voie de la barrière)
+        if (!manual)
+        {
+            uint16_t preopen_units = in.preopen_angle * SERVO_UNITS_PER_DEG;
+            uint16_t target = servo_units;
+
+            if (in.occupancy & 1)
+                target = in.open_angle * SERVO_UNITS_PER_DEG;  // Voiture : ouverture
+            else if (preopen_units > servo_units)
+                target = preopen_units;                         // Voiture en approche
+            else if (released_flags[0] && !preopen_units)
+                target = 0;                                     // Partie depuis le maintien
+
+            out.barrier_cycle = target && servo_units == 0;
+            servo_units = target;
+        }
+        out.servo_units = servo_units;
+
+        // 4. Transitions à journaliser
+        if (manual != reported_manual)
+        {
+            reported_manual = manual;
+            push_event(out, now_ms, EVENT_MODE, manual);
+        }
+        if (servo_units != reported_units)
+        {
+            reported_units = servo_units;
+            push_event(out, now_ms, EVENT_BARRIER, servo_units / SERVO_UNITS_PER_DEG);
+        }
+    }
+
+    // Feux de la voie de la barrière et éclairage
+    static uint8_t leds(bool dark, bool lane_car, bool lane_released)
+    {
+        uint8_t state = dark ? CONTROLLER_LED_WHITE : 0;
+
+        // Rouge tant que la voiture est là ou que le maintien court
+        state |= lane_car || !lane_released ? CONTROLLER_LED_RED : CONTROLLER_LED_GREEN;
+        return state;
+    }
+
+    bool     is_manual() const                  { return manual; }
+    uint16_t servo() const                      { return servo_units; }
+    uint8_t  release_counter(uint8_t n) const   { return counter[n]; }
+    bool     released(uint8_t n) const          { return released_flags[n]; }
+
+private:
+    static void push_event(ControllerOutputs &out, uint32_t now_ms, uint8_t type, uint8_t value)
+    {
+        event_t *e = &out.events[out.event_count++];
+        e->timestamp = now_ms;
+        e->type = type;
+        e->value = value;
+    }
+
+    uint16_t servo_units;
+    bool     manual;
+    bool     reported_manual;
+    uint16_t reported_units;
+    uint8_t  counter[Spots];            // Cycles depuis le départ de la voiture
+    uint8_t  released_flags[Spots];
+};
+
+#endif
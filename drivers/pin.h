@@ -0,0 +1,66 @@
+#ifndef PIN_H
+#define PIN_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/*
+ * Accès aux broches résolu à la compilation : Pin<PortD, PD2>::high()
+ * devient un seul sbi, read() un sbis/sbic, sans variable ni pointeur.
+ * Chaque opération ne touche qu'un bit en une instruction : elle est
+ * atomique même si plusieurs tâches partagent le même port.
+ *
+ * Hors AVR (build hôte), les registres sont remplacés par un tableau
+ * simulé consultable avec gpio_mock_register().
+ */
+
+#if defined(__AVR__)
+#define GPIO_REG(io_addr)   _SFR_IO8(io_addr)
+#else
+inline volatile uint8_t &gpio_mock_register(uint8_t io_addr)
+{
+    static volatile uint8_t file[0x40];
+    return file[io_addr];
+}
+#define GPIO_REG(io_addr)   gpio_mock_register(io_addr)
+#endif
+
+#define GPIO_INLINE static inline __attribute__((always_inline))
+
+// Un port AVR : PINx, DDRx et PORTx se suivent dans l'espace d'E/S
+template <uint8_t PinAddr>
+struct GpioPort
+{
+    GPIO_INLINE volatile uint8_t &pin()  { return GPIO_REG(PinAddr); }
+    GPIO_INLINE volatile uint8_t &ddr()  { return GPIO_REG(PinAddr + 1); }
+    GPIO_INLINE volatile uint8_t &port() { return GPIO_REG(PinAddr + 2); }
+};
+
+typedef GpioPort<0x03> PortB;
+typedef GpioPort<0x06> PortC;
+typedef GpioPort<0x09> PortD;
+
+template <class Port, uint8_t Bit>
+struct Pin
+{
+    GPIO_INLINE void output()     { Port::ddr() |= _BV(Bit); }
+    GPIO_INLINE void input()      { Port::ddr() &= ~_BV(Bit); }
+    GPIO_INLINE void high()       { Port::port() |= _BV(Bit); }
+    GPIO_INLINE void low()        { Port::port() &= ~_BV(Bit); }
+    GPIO_INLINE void set(bool on) { if (on) high(); else low(); }
+    GPIO_INLINE bool read()       { return Port::pin() & _BV(Bit); }
+
+    // Entrée avec pull-up (= niveau haut d'une ligne open-drain)
+    GPIO_INLINE void pullup()     { input(); high(); }
+
+    GPIO_INLINE void toggle()
+    {
+#if defined(__AVR__)
+        Port::pin() = _BV(Bit);   // Ecrire 1 dans PINx inverse le bit de PORTx
+#else
+        Port::port() ^= _BV(Bit);
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "preopen.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "params.h"
+
+#define AVG_SHIFT       2           // Moyenne exponentielle sur ~4 voitures
+
+static volatile preopen_stats_t stats;
+
+// Pré-ouverture en cours
+static uint8_t  active = 0;
+static uint8_t  prev_approach = 0;
+static uint32_t active_since_ms = 0;
+
+// Barrière : dernier angle commandé et fin estimée du mouvement
+static uint8_t  barrier_deg = 0;
+static uint32_t move_end_ms = 0;
+static uint8_t  open_known = 0;     // barrier_deg >= open_angle, ouverte à move_end_ms
+
+// Voiture devant la barrière
+static uint8_t  car_present = 0;
+static uint8_t  car_waiting = 0;    // Attente pas encore mesurée
+static uint8_t  car_preopened = 0;
+static uint32_t arrival_ms = 0;
+static uint8_t  seen[3];            // Premières mesures de chaque moyenne
+
+volatile preopen_stats_t *preopen_stats(void)
+{
+    return &stats;
+}
+
+static uint16_t clamp_ms(uint32_t ms)
+{
+    return ms > 0xFFFF ? 0xFFFF : ms;
+}
+
+// Appelé sous section critique
+static void average(volatile uint16_t *avg, uint8_t *first, uint16_t value)
+{
+    if (!*first)
+    {
+        *avg = value;
+        *first = 1;
+    }
+    else
+    {
+        *avg = *avg - (*avg >> AVG_SHIFT) + (value >> AVG_SHIFT);
+    }
+}
+
+uint8_t preopen_update(uint8_t approach, uint8_t lane_car, uint32_t now_ms)
+{
+    uint8_t angle = params_get(PARAM_PREOPEN_ANGLE);
+    uint8_t open_angle = params_get(PARAM_OPEN_ANGLE);
+    uint8_t rising = approach && !prev_approach;
+
+    prev_approach = approach;
+    if (angle == 0)
+    {
+        active = 0;
+        return 0;
+    }
+
+    // Une voiture déjà devant la barrière la garde ouverte : seule une
+    // nouvelle entrée dans la zone d'approche arme la pré-ouverture
+    if (rising && !lane_car && !active)
+    {
+        active = 1;
+        active_since_ms = now_ms;
+    }
+
+    if (active && now_ms - active_since_ms >= params_get(PARAM_PREOPEN_TIMEOUT_MS))
+    {
+        active = 0;
+        taskENTER_CRITICAL();
+        stats.preopen_timeouts++;
+        taskEXIT_CRITICAL();
+    }
+
+    if (!active)
+        return 0;
+    return angle < open_angle ? angle : open_angle;
+}
+
+void preopen_barrier(uint8_t angle_deg, uint32_t now_ms)
+{
+    if (angle_deg != barrier_deg)
+    {
+        // Les mouvements s'enchaînent : pré-ouverture puis ouverture complète
+        uint8_t travel = angle_deg > barrier_deg ? angle_deg - barrier_deg : barrier_deg - angle_deg;
+        uint32_t start = (int32_t)(move_end_ms - now_ms) > 0 ? move_end_ms : now_ms;
+
+        move_end_ms = start + (uint32_t)travel * params_get(PARAM_SERVO_MS_PER_DEG);
+        barrier_deg = angle_deg;
+        open_known = angle_deg >= params_get(PARAM_OPEN_ANGLE);
+    }
+
+    if (!car_waiting || !open_known)
+        return;
+
+    car_waiting = 0;
+    uint16_t wait = (int32_t)(move_end_ms - arrival_ms) > 0 ? clamp_ms(move_end_ms - arrival_ms) : 0;
+
+    taskENTER_CRITICAL();
+    stats.last_wait_ms = wait;
+    average(&stats.avg_wait_ms[car_preopened], &seen[car_preopened], wait);
+    taskEXIT_CRITICAL();
+}
+
+void preopen_car_arrived(uint32_t now_ms)
+{
+    car_present = 1;
+    car_waiting = 1;
+    car_preopened = active;
+    arrival_ms = now_ms;
+    active = 0;     // La barrière s'ouvre en grand, le délai ne s'applique plus
+
+    taskENTER_CRITICAL();
+    stats.cars++;
+    stats.preopened_cars += car_preopened;
+    taskEXIT_CRITICAL();
+}
+
+void preopen_car_left(uint32_t now_ms)
+{
+    if (!car_present)
+        return;
+
+    // Voiture repartie avant l'ouverture complète : pas d'attente mesurable
+    car_present = 0;
+    car_waiting = 0;
+    uint16_t clear = clamp_ms(now_ms - arrival_ms);
+
+    taskENTER_CRITICAL();
+    stats.last_clear_ms = clear;
+    average(&stats.avg_clear_ms, &seen[2], clear);
+    taskEXIT_CRITICAL();
+}
+
+void preopen_reset(void)
+{
+    active = 0;
+    prev_approach = 0;
+    active_since_ms = 0;
+    barrier_deg = 0;
+    move_end_ms = 0;
+    open_known = 0;
+    car_present = 0;
+    car_waiting = 0;
+    car_preopened = 0;
+    arrival_ms = 0;
+    memset(seen, 0, sizeof(seen));
+
+    taskENTER_CRITICAL();
+    memset((void *)&stats, 0, sizeof(stats));
+    taskEXIT_CRITICAL();
+}
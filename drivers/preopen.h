@@ -0,0 +1,53 @@
+#ifndef PREOPEN_H
+#define PREOPEN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pré-ouverture de la barrière par un capteur d'approche placé en amont.
+// Quand une voiture entre dans la zone d'approche, la barrière s'ouvre à
+// preopen_angle (partielle si plus petit que open_angle) ; si aucune voiture
+// n'atteint la barrière dans preopen_timeout_ms, elle se referme.
+// preopen_angle = 0 désactive la fonction (pas de capteur d'approche).
+//
+// Le servo n'a pas de retour de position : la fin de course est estimée avec
+// servo_ms_per_deg. Temps mesurés pour chaque voiture :
+//   attente       : arrivée devant la barrière -> barrière ouverte en grand
+//   dégagement    : arrivée devant la barrière -> capteur de la barrière libéré
+
+// Page I2C "approach", little-endian
+typedef struct
+{
+    uint16_t cars;                  // Voitures arrivées à la barrière
+    uint16_t preopened_cars;        // ... dont la barrière était pré-ouverte
+    uint16_t preopen_timeouts;      // Pré-ouvertures refermées sans voiture
+    uint16_t last_wait_ms;
+    uint16_t last_clear_ms;
+    uint16_t avg_wait_ms[2];        // Moyenne glissante [0] sans, [1] avec pré-ouverture
+    uint16_t avg_clear_ms;
+} preopen_stats_t;
+
+volatile preopen_stats_t *preopen_stats(void);
+
+// À appeler à chaque cycle de la tâche servo en mode automatique. Retourne
+// l'angle de pré-ouverture à appliquer (degrés), 0 s'il n'y en a pas.
+uint8_t preopen_update(uint8_t approach, uint8_t lane_car, uint32_t now_ms);
+
+// Angle de la barrière (degrés) après chaque cycle de la tâche servo
+void    preopen_barrier(uint8_t angle_deg, uint32_t now_ms);
+
+// Arrivée et départ d'une voiture devant la barrière (horodatage du capteur)
+void    preopen_car_arrived(uint32_t now_ms);
+void    preopen_car_left(uint32_t now_ms);
+
+// Revient à l'état du démarrage, mesures comprises (simulateur de trafic)
+void    preopen_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
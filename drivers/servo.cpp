@@ -1,6 +1,8 @@
 #include "servo.h"
 #include <avr/io.h>
 
+#include "pin.h"
+
 /*
  * Servo sur D6 (PD6, OC0A)
  * Timer0 → Fast PWM, TOP = 0xFF, prescaler = 1024
@@ -12,7 +14,7 @@
 void servo_init(void)
 {
     // D6 = PD6 = OC0A en sortie
-    DDRD |= (1 << PD6);
+    Pin<PortD, PD6>::output();
 
     // Fast PWM, TOP = 0xFF
     // WGM01=1, WGM00=1, WGM02=0
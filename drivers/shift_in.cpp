@@ -0,0 +1,34 @@
+#include "shift_in.h"
+#include "pin.h"
+
+typedef Pin<PortB, PB2> ShiftLoad;  // SH/LD, actif à l'état bas (aussi SS : doit rester en sortie)
+typedef Pin<PortB, PB5> ShiftClk;
+typedef Pin<PortB, PB4> ShiftData;
+
+void shift_in_init(void)
+{
+    ShiftLoad::high();
+    ShiftLoad::output();
+    ShiftClk::output();
+    ShiftData::input();
+
+    // SPI maître, mode 0, MSB d'abord (H sort en premier), F_CPU/16 = 1 MHz
+    SPCR = (1 << SPE) | (1 << MSTR) | (1 << SPR0);
+}
+
+void shift_in_read(uint8_t *buf, uint8_t chips)
+{
+    // Impulsion de chargement : cbi puis sbi, soit 2 cycles (125 ns) au
+    // niveau bas, au-delà du minimum du 74HC165 (20 ns sous 4,5 V)
+    ShiftLoad::low();
+    ShiftLoad::high();
+
+    // 8 µs par boîtier, attente active plus courte qu'un changement de contexte
+    for (uint8_t i = 0; i < chips; i++)
+    {
+        SPDR = 0;
+        while (!(SPSR & (1 << SPIF)))
+            ;
+        buf[i] = SPDR;
+    }
+}
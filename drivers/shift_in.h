@@ -0,0 +1,25 @@
+#ifndef SHIFT_IN_H
+#define SHIFT_IN_H
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Registres à décalage d'entrée 74HC165 chaînés, lus par le SPI matériel :
+//   SH/LD -> PB2 (D10)    CLK -> PB5 (D13, SCK)    QH -> PB4 (D12, MISO)
+// Le chargement parallèle fige toutes les entrées au même instant, une seule
+// transaction SPI les ramène toutes.
+
+void shift_in_init(void);
+
+// buf[0] = 74HC165 relié à MISO, bit n = entrée n (A = bit 0, H = bit 7)
+void shift_in_read(uint8_t *buf, uint8_t chips);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,11 +1,43 @@
 #include "soft_i2c.h"
 #include <Wire.h>
 
-// Registres I2C (16 registres disponibles)
-static volatile uint8_t registers[16];
+// Registres I2C
+static volatile uint8_t registers[SOFT_I2C_REGISTER_COUNT];
 static volatile uint8_t current_register = 0;
 static volatile bool register_selected = false;
 
+// Callback de verrouillage appelé avant une lecture (voir soft_i2c_on_read)
+static uint8_t latch_register = 0xFF;
+static void (*latch_callback)(void) = 0;
+
+// Registres flux (voir soft_i2c_on_stream)
+#define MAX_STREAMS 4
+static uint8_t stream_registers[MAX_STREAMS];
+static void (*stream_callbacks[MAX_STREAMS])(void);
+static uint8_t stream_count = 0;
+
+// Pages (voir soft_i2c_add_page), la page 0 est `registers`
+typedef struct
+{
+    uint8_t id;
+    uint8_t count;              // Pages id à id + count - 1 (tableau de structs)
+    uint8_t size;
+    uint8_t writable;
+    volatile uint8_t *data;
+    void (*stream)(void);
+} page_t;
+
+static page_t pages[SOFT_I2C_MAX_PAGES];
+static uint8_t page_count = 0;
+static volatile uint8_t current_page = 0;
+
+volatile soft_i2c_stats_t soft_i2c_bus_stats;
+
+volatile soft_i2c_stats_t *soft_i2c_stats(void)
+{
+    return &soft_i2c_bus_stats;
+}
+
 void soft_i2c_set_register(uint8_t reg, uint8_t value)
 {
     if (reg < sizeof(registers))
@@ -19,6 +51,115 @@ uint8_t soft_i2c_get_register(uint8_t reg)
     return 0xFF;
 }
 
+void soft_i2c_on_read(uint8_t reg, void (*callback)(void))
+{
+    latch_register = reg;
+    latch_callback = callback;
+}
+
+void soft_i2c_on_stream(uint8_t reg, void (*callback)(void))
+{
+    if (stream_count < MAX_STREAMS)
+    {
+        stream_registers[stream_count] = reg;
+        stream_callbacks[stream_count] = callback;
+        stream_count++;
+    }
+}
+
+void soft_i2c_write(const uint8_t *data, uint8_t length)
+{
+    Wire.write(data, length);
+}
+
+static void add_page(uint8_t id, uint8_t count, volatile void *data, uint8_t size,
+                     uint8_t writable, void (*stream)(void))
+{
+    if (page_count < SOFT_I2C_MAX_PAGES && id != 0)
+    {
+        pages[page_count].id = id;
+        pages[page_count].count = count;
+        pages[page_count].size = size;
+        pages[page_count].writable = writable;
+        pages[page_count].data = (volatile uint8_t *)data;
+        pages[page_count].stream = stream;
+        page_count++;
+    }
+}
+
+void soft_i2c_add_page(uint8_t page, volatile void *data, uint8_t size, uint8_t writable)
+{
+    add_page(page, 1, data, size, writable, 0);
+}
+
+void soft_i2c_add_page_array(uint8_t first_page, uint8_t count, volatile void *data,
+                             uint8_t size, uint8_t writable)
+{
+    add_page(first_page, count, data, size, writable, 0);
+}
+
+void soft_i2c_add_stream_page(uint8_t page, void (*callback)(void))
+{
+    add_page(page, 1, 0, 0, 0, callback);
+}
+
+static page_t *find_page(uint8_t id)
+{
+    for (uint8_t i = 0; i < page_count; i++)
+    {
+        if ((uint8_t)(id - pages[i].id) < pages[i].count)
+            return &pages[i];
+    }
+    return 0;
+}
+
+// Mémoire de la page courante dans un tableau de pages
+static volatile uint8_t *page_data(page_t *page)
+{
+    return page->data + (uint16_t)(current_page - page->id) * page->size;
+}
+
+// Ecriture du master dans une page autre que 0
+static void page_receive(int numBytes)
+{
+    page_t *page = find_page(current_page);
+
+    while (numBytes > 0 && Wire.available())
+    {
+        uint8_t value = Wire.read();
+        if (page && page->writable && current_register < page->size)
+            page_data(page)[current_register++] = value;
+        else
+            soft_i2c_bus_stats.invalid++;
+        numBytes--;
+    }
+}
+
+// Lecture du master dans une page autre que 0 : comme pour la page 0, tous
+// les octets à partir du registre courant partent dans la même rafale.
+static void page_request(void)
+{
+    page_t *page = find_page(current_page);
+
+    if (page && page->stream)
+    {
+        page->stream();
+    }
+    else if (page && current_register < page->size)
+    {
+        uint8_t count = page->size - current_register;
+        if (count > BUFFER_LENGTH)
+            count = BUFFER_LENGTH;
+        Wire.write((const uint8_t *)&page_data(page)[current_register], count);
+        current_register++;
+    }
+    else
+    {
+        Wire.write(0xFF); // Page inconnue ou hors de la page
+        soft_i2c_bus_stats.invalid++;
+    }
+}
+
 // Callback appelé quand le master envoie des données
 void receiveEvent(int numBytes)
 {
@@ -28,6 +169,21 @@ void receiveEvent(int numBytes)
         current_register = Wire.read();
         register_selected = true;
         numBytes--;
+
+        if (current_register == SOFT_I2C_PAGE_SELECT)
+        {
+            if (numBytes > 0 && Wire.available())
+                current_page = Wire.read();
+            while (Wire.available())
+                Wire.read();
+            return;
+        }
+
+        if (current_page != 0)
+        {
+            page_receive(numBytes);
+            return;
+        }
         
         // Bytes suivants = données à écrire dans les registres
         while (numBytes > 0 && Wire.available())
@@ -40,6 +196,7 @@ void receiveEvent(int numBytes)
             else
             {
                 Wire.read(); // Ignorer les données en surplus
+                soft_i2c_bus_stats.invalid++;
             }
             numBytes--;
         }
@@ -47,11 +204,45 @@ void receiveEvent(int numBytes)
 }
 
 // Callback appelé quand le master demande des données
+// Tous les registres à partir du registre courant sont placés dans le buffer
+// d'émission : une lecture en rafale (block read) les reçoit à la suite.
 void requestEvent()
 {
+    if (register_selected && current_register == SOFT_I2C_PAGE_SELECT)
+    {
+        Wire.write(current_page);
+        return;
+    }
+
+    if (register_selected && current_page != 0)
+    {
+        page_request();
+        return;
+    }
+
+    if (register_selected)
+    {
+        // Registre flux : le registre courant reste sélectionné, chaque
+        // nouvelle lecture continue de vider la FIFO
+        for (uint8_t i = 0; i < stream_count; i++)
+        {
+            if (stream_registers[i] == current_register)
+            {
+                stream_callbacks[i]();
+                return;
+            }
+        }
+    }
+
     if (register_selected && current_register < sizeof(registers))
     {
-        Wire.write(registers[current_register]);
+        if (current_register == latch_register && latch_callback)
+            latch_callback();
+
+        uint8_t count = sizeof(registers) - current_register;
+        if (count > BUFFER_LENGTH)
+            count = BUFFER_LENGTH;
+        Wire.write((const uint8_t *)&registers[current_register], count);
         current_register++;
         
         // Retour au début si on dépasse
@@ -60,7 +251,8 @@ void requestEvent()
     }
     else
     {
-        Wire.write(0xFF); // Valeur par défaut
+        Wire.write(0xFF); // Valeur par défaut : aucun registre sélectionné ou hors banque
+        soft_i2c_bus_stats.invalid++;
     }
 }
 
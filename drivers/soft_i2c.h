@@ -3,20 +3,83 @@
 
 #include <stdint.h>
 
+// Nombre de registres exposés au master (page 0)
+#define SOFT_I2C_REGISTER_COUNT 36
+
+// L'esclave tient SCL bas (étirement d'horloge) pendant l'ISR TWI. Le
+// contrôleur de la Pi abandonne au-delà de 64 périodes de SCL, soit 160 µs à
+// 400 kHz : on garde de la marge pour la latence d'interruption (tick).
+#define SOFT_I2C_ISR_BUDGET_US  100
+
+// Sélection de page : écrire [0xFF, page] ; lisible depuis toutes les pages.
+// La page 0 est la banque de registres ci-dessous, les autres pages sont
+// servies directement depuis la mémoire de leur sous-système.
+#define SOFT_I2C_PAGE_SELECT    0xFF
+#define SOFT_I2C_MAX_PAGES      13
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Compteurs de l'esclave (16 bits little-endian, rebouclent à 65536), mis à
+// jour sous interruption par l'ISR TWI (twi.c) et les callbacks ci-dessous.
+// Servis tels quels par une page : le master calcule les écarts entre deux
+// lectures pour les rapprocher de ses propres erreurs.
+typedef struct
+{
+    uint16_t writes;            // Transactions d'écriture du master (STOP reçu)
+    uint16_t reads;             // Transactions de lecture du master
+    uint16_t bytes_in;
+    uint16_t bytes_out;
+    uint16_t overruns;          // Octets refusés (NACK), buffer de réception plein
+    uint16_t bus_errors;        // START/STOP illégal (TW_BUS_ERROR)
+    uint16_t invalid;           // Registre ou page inexistant, page en lecture seule
+    uint16_t isr_max_us;        // Plus longue ISR TWI (callbacks compris)
+    uint16_t slow_isr;          // ISR TWI plus longues que SOFT_I2C_ISR_BUDGET_US
+} soft_i2c_stats_t;
+
+extern volatile soft_i2c_stats_t soft_i2c_bus_stats;
+
+volatile soft_i2c_stats_t *soft_i2c_stats(void);
+
 // Initialise le bus I2C en mode slave
 // Note: Utilise les pins A4 (SDA) et A5 (SCL) - pins I2C matérielles
 void soft_i2c_init(uint8_t address);
 
-// Lit un registre I2C (0-15)
+// Lit un registre I2C (0 à SOFT_I2C_REGISTER_COUNT-1)
 uint8_t soft_i2c_get_register(uint8_t reg);
 
-// Écrit dans un registre I2C (0-15)
+// Écrit dans un registre I2C (0 à SOFT_I2C_REGISTER_COUNT-1)
 void    soft_i2c_set_register(uint8_t reg, uint8_t value);
 
+// Enregistre une fonction appelée (sous interruption) quand le master
+// commence une lecture au registre `reg`, avant l'envoi des octets.
+// Sert à figer une valeur multi-octets (ex. compteur 32 bits) pour qu'elle
+// soit lue de façon cohérente, comme le registre TEMP des timers AVR.
+void    soft_i2c_on_read(uint8_t reg, void (*callback)(void));
+
+// Déclare `reg` comme registre "flux" (FIFO) : une lecture à ce registre
+// n'envoie pas la banque mais ce que `callback` écrit avec soft_i2c_write()
+// (appelé sous interruption, 32 octets max par lecture).
+void    soft_i2c_on_stream(uint8_t reg, void (*callback)(void));
+void    soft_i2c_write(const uint8_t *data, uint8_t length);
+
+// Déclare une page de `size` octets lue directement dans `data` (struct du
+// sous-système) : le registre n de la page est l'octet n de la struct.
+// Le sous-système modifie ses champs multi-octets en section critique pour
+// que le master ne lise jamais une valeur à moitié mise à jour.
+// `writable` autorise le master à écrire dans la page.
+void    soft_i2c_add_page(uint8_t page, volatile void *data, uint8_t size, uint8_t writable);
+
+// Déclare `count` pages consécutives à partir de `first_page`, servies depuis
+// un tableau de structs de `size` octets (une page par élément)
+void    soft_i2c_add_page_array(uint8_t first_page, uint8_t count, volatile void *data,
+                                uint8_t size, uint8_t writable);
+
+// Déclare une page flux : toute lecture dans la page appelle `callback`
+// (même principe que soft_i2c_on_stream)
+void    soft_i2c_add_stream_page(uint8_t page, void (*callback)(void));
+
 #ifdef __cplusplus
 }
 #endif
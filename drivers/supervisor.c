@@ -0,0 +1,134 @@
+#include "supervisor.h"
+
+#include <avr/io.h>
+#include <avr/wdt.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define BOOT_MAGIC  0xB007
+
+// Conservés à travers un reset (hors mise sous tension)
+static uint8_t  reset_cause  __attribute__((section(".noinit")));
+static uint16_t boot_magic   __attribute__((section(".noinit")));
+static uint8_t  reboot_count __attribute__((section(".noinit")));
+
+#if configCHECK_FOR_STACK_OVERFLOW
+#define OVERFLOW_MAGIC  0x57AC
+
+static uint16_t overflow_magic __attribute__((section(".noinit")));
+char supervisor_overflow_task[configMAX_TASK_NAME_LEN] __attribute__((section(".noinit")));
+#endif
+
+static uint8_t expected_mask = 0;
+static volatile uint8_t alive_mask = 0;
+static volatile uint8_t heartbeat = 0;
+
+// Optiboot efface MCUSR avant de lancer l'application mais transmet sa
+// valeur dans r2 : on la sauve avant que le runtime C ne réutilise r2.
+void supervisor_save_r2(void) __attribute__((naked, used, section(".init0")));
+void supervisor_save_r2(void)
+{
+    __asm__ __volatile__ ("sts %0, r2" : "=m" (reset_cause));
+}
+
+// Après un reset watchdog, le WDT reste actif avec le timeout minimal :
+// il faut le couper avant l'initialisation du runtime C.
+void supervisor_early_init(void) __attribute__((naked, used, section(".init3")));
+void supervisor_early_init(void)
+{
+    uint8_t mcusr = MCUSR;
+
+    if (mcusr)
+        reset_cause = mcusr;    // Pas de bootloader : MCUSR est encore valide
+    MCUSR = 0;
+    wdt_disable();
+}
+
+void supervisor_init(uint8_t mask)
+{
+    expected_mask = mask;
+
+    // Mise sous tension / brown-out : la RAM n'est plus fiable
+    if ((reset_cause & (_BV(PORF) | _BV(BORF))) || boot_magic != BOOT_MAGIC)
+    {
+        boot_magic = BOOT_MAGIC;
+        reboot_count = 0;
+    }
+    else if (reboot_count < 255)
+    {
+        reboot_count++;
+    }
+
+#if configCHECK_FOR_STACK_OVERFLOW
+    // reboot_count > 0 : RAM conservée depuis le démarrage précédent
+    if (reboot_count && overflow_magic == OVERFLOW_MAGIC && (reset_cause & _BV(WDRF)))
+        reset_cause |= SUPERVISOR_RESET_STACK;
+    overflow_magic = 0;
+#endif
+}
+
+#if configCHECK_FOR_STACK_OVERFLOW
+// Appelé par le noyau au changement de contexte, sur la pile qui vient de
+// déborder : on note la tâche et on laisse le watchdog redémarrer au plus vite.
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name)
+{
+    (void)task;
+
+    portDISABLE_INTERRUPTS();
+    for (uint8_t i = 0; i < configMAX_TASK_NAME_LEN; i++)
+        supervisor_overflow_task[i] = name[i];
+    overflow_magic = OVERFLOW_MAGIC;
+
+    wdt_enable(WDTO_15MS);
+    for (;;)
+        ;
+}
+#endif
+
+void supervisor_start_watchdog(void)
+{
+    wdt_enable(WDTO_2S);
+}
+
+void supervisor_checkin(uint8_t task_bit)
+{
+    taskENTER_CRITICAL();
+    alive_mask |= task_bit;
+    taskEXIT_CRITICAL();
+}
+
+uint8_t supervisor_update(void)
+{
+    uint8_t all_alive;
+
+    taskENTER_CRITICAL();
+    all_alive = (alive_mask & expected_mask) == expected_mask;
+    if (all_alive)
+        alive_mask = 0;
+    taskEXIT_CRITICAL();
+
+    // Une tâche bloquée empêche le rafraîchissement : reset au bout de 2 s
+    if (all_alive)
+    {
+        heartbeat++;
+        wdt_reset();
+    }
+
+    return all_alive;
+}
+
+uint8_t supervisor_heartbeat(void)
+{
+    return heartbeat;
+}
+
+uint8_t supervisor_reset_cause(void)
+{
+    return reset_cause;
+}
+
+uint8_t supervisor_reboot_count(void)
+{
+    return reboot_count;
+}
@@ -0,0 +1,32 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Supervision des tâches : chaque tâche signale qu'elle tourne avec
+// supervisor_checkin(), le heartbeat n'avance et le watchdog matériel n'est
+// rafraîchi que lorsque toutes les tâches attendues se sont signalées.
+
+// Ajouté à la cause du reset quand le watchdog a été déclenché par un
+// débordement de pile (build make DEBUG=1). Le nom de la tâche fautive reste
+// dans supervisor_overflow_task jusqu'au débordement suivant (débogueur).
+#define SUPERVISOR_RESET_STACK  0x80
+
+void    supervisor_init(uint8_t expected_mask); // Masque des tâches à surveiller
+void    supervisor_start_watchdog(void);        // Arme le watchdog AVR (2 s)
+void    supervisor_checkin(uint8_t task_bit);   // Appelé par chaque tâche à chaque cycle
+uint8_t supervisor_update(void);                // Retourne 1 si toutes les tâches ont répondu
+
+uint8_t supervisor_heartbeat(void);             // Compteur de cycles complets (modulo 256)
+uint8_t supervisor_reset_cause(void);           // Copie de MCUSR au démarrage (+ SUPERVISOR_RESET_STACK)
+uint8_t supervisor_reboot_count(void);          // Redémarrages depuis la mise sous tension
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
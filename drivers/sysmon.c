@@ -0,0 +1,209 @@
+#include "sysmon.h"
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Timer1 génère le tick FreeRTOS (mode CTC, prescaler 64, voir port.c) :
+ * un pas de TCNT1 = 4 µs, TOP = 249 à 1 kHz. Couplé au compteur de ticks,
+ * il fournit une base de temps libre de 4 µs sans utiliser d'autre timer.
+ *
+ * L'idle hook est appelé en boucle par la tâche idle. A chaque appel on
+ * mesure le temps écoulé depuis l'appel précédent : un écart court veut dire
+ * que la tâche idle a tourné sans interruption, un écart long qu'une tâche
+ * ou une ISR a pris la main entre-temps (non compté comme idle).
+ * Les ISR plus courtes que IDLE_GAP_MAX sont comptées comme idle, la charge
+ * est donc légèrement sous-estimée (de l'ordre du %).
+ */
+
+#define TIMER_PRESCALER     64
+#define COUNTS_PER_TICK     (configCPU_CLOCK_HZ / configTICK_RATE_HZ / TIMER_PRESCALER) // 250
+#define US_PER_COUNT        (1000000UL * TIMER_PRESCALER / configCPU_CLOCK_HZ)           // 4 µs
+
+#define IDLE_GAP_MAX        5                       // 5 * 4 µs = 20 µs
+#define WINDOW_TICKS        configTICK_RATE_HZ      // Fenêtre de mesure : 1 s
+#define WINDOW_COUNTS       ((uint32_t)COUNTS_PER_TICK * WINDOW_TICKS)
+#define LOAD_AVG_SAMPLES    60                      // Constante de temps de la moyenne : 60 s
+
+_Static_assert(configTICK_RATE_HZ == 1000, "sysmon_uptime_ms() suppose un tick de 1 ms");
+
+// Partagé entre l'idle hook et le tick hook (accès sous interruptions masquées)
+static uint32_t idle_counts = 0;        // Temps idle dans la fenêtre en cours
+static uint32_t idle_window = 0;        // Temps idle de la dernière fenêtre complète
+static volatile uint8_t window_ready = 0;
+static volatile uint16_t tick_gap_max = 0; // En pas de Timer1
+
+// Poids fort de l'uptime : nombre de rebouclages du compteur de ticks
+static volatile uint16_t uptime_hi = 0;
+static volatile TickType_t uptime_last_tick = 0;
+
+static uint16_t load_60s_fp = 0;        // Virgule fixe 8.8
+static uint8_t  load_60s_valid = 0;
+
+static volatile sysmon_stats_t stats;
+
+void vApplicationIdleHook(void)
+{
+    static TickType_t prev_tick = 0;
+    static uint8_t prev_count = 0;
+
+    portENTER_CRITICAL();
+
+    TickType_t tick = xTaskGetTickCountFromISR();
+    uint8_t count = (uint8_t)TCNT1;
+
+    // Comparaison atteinte mais tick pas encore traité : le compteur est
+    // déjà repassé à 0, on avance le tick d'un cran.
+    if ((TIFR1 & _BV(OCF1A)) && count < COUNTS_PER_TICK / 2)
+        tick++;
+
+    TickType_t elapsed = tick - prev_tick;
+    if (elapsed <= 1)
+    {
+        int16_t delta = (int16_t)elapsed * COUNTS_PER_TICK + count - prev_count;
+        if (delta >= 0 && delta <= IDLE_GAP_MAX)
+            idle_counts += (uint8_t)delta;
+    }
+
+    prev_tick = tick;
+    prev_count = count;
+
+    portEXIT_CRITICAL();
+}
+
+// Appelé depuis l'ISR du tick : TCNT1 contient la latence depuis la
+// comparaison, l'écart entre deux ticks vaut donc TOP + 1 + (lat - lat_prec).
+void vApplicationTickHook(void)
+{
+    static uint8_t prev_latency = 0;
+    static uint16_t window_ticks = 0;
+
+    // Le hook n'est pas rappelé pour les ticks rattrapés après une suspension
+    // du scheduler : on détecte le rebouclage plutôt que le passage par 0.
+    TickType_t now = xTaskGetTickCountFromISR();
+    if (now < uptime_last_tick)
+        uptime_hi++;
+    uptime_last_tick = now;
+
+    uint8_t latency = (uint8_t)TCNT1;
+    uint16_t gap = COUNTS_PER_TICK + latency - prev_latency;
+    prev_latency = latency;
+
+    if (gap > tick_gap_max)
+        tick_gap_max = gap;
+
+    if (++window_ticks >= WINDOW_TICKS)
+    {
+        window_ticks = 0;
+        idle_window = idle_counts;
+        idle_counts = 0;
+        window_ready = 1;
+    }
+}
+
+void sysmon_update(void)
+{
+    uint32_t idle;
+    uint8_t load_1s;
+
+    taskENTER_CRITICAL();
+    stats.tick_gap_max_us = tick_gap_max * US_PER_COUNT;
+    if (!window_ready)
+    {
+        taskEXIT_CRITICAL();
+        return;
+    }
+    idle = idle_window;
+    window_ready = 0;
+    taskEXIT_CRITICAL();
+
+    if (idle > WINDOW_COUNTS)
+        idle = WINDOW_COUNTS;
+
+    load_1s = 100 - (uint8_t)(idle * 100 / WINDOW_COUNTS);
+
+    // Moyenne exponentielle (même principe que le loadavg Unix)
+    if (!load_60s_valid)
+    {
+        load_60s_fp = (uint16_t)load_1s << 8;
+        load_60s_valid = 1;
+    }
+    else
+    {
+        int32_t diff = ((int32_t)load_1s << 8) - load_60s_fp;
+        load_60s_fp += diff / LOAD_AVG_SAMPLES;
+    }
+
+    stats.cpu_load_1s = load_1s;
+    stats.cpu_load_60s = (load_60s_fp + 0x80) >> 8;
+}
+
+volatile sysmon_stats_t *sysmon_stats(void)
+{
+    return &stats;
+}
+
+uint32_t sysmon_uptime_ms(void)
+{
+    TickType_t now;
+    uint16_t hi;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        now = xTaskGetTickCountFromISR();
+        hi = uptime_hi;
+        // Rebouclage pas encore vu par le tick hook
+        if (now < uptime_last_tick)
+            hi++;
+    }
+
+    return ((uint32_t)hi << 16) | now;
+}
+
+uint32_t sysmon_timer_timestamp(uint8_t counts)
+{
+    uint8_t now, again;
+    uint8_t pending;
+    int8_t adjust;
+
+    // Lecture cohérente de TCNT1 et du flag de comparaison
+    do
+    {
+        now = (uint8_t)TCNT1;
+        pending = TIFR1 & _BV(OCF1A);
+        again = (uint8_t)TCNT1;
+    } while (again < now);
+
+    // `counts` est antérieur à `now` de moins d'un tick : s'il est plus grand,
+    // un rebouclage de TCNT1 a eu lieu entre les deux.
+    if (pending)
+        adjust = counts <= now ? 1 : 0;     // Rebouclage pas encore compté
+    else
+        adjust = counts <= now ? 0 : -1;    // Capture avant le dernier tick
+
+    return (sysmon_uptime_ms() + adjust) * COUNTS_PER_TICK + counts;
+}
+
+uint8_t sysmon_cpu_load_1s(void)
+{
+    return stats.cpu_load_1s;
+}
+
+uint8_t sysmon_cpu_load_60s(void)
+{
+    return stats.cpu_load_60s;
+}
+
+uint16_t sysmon_tick_gap_max(void)
+{
+    uint16_t gap;
+
+    taskENTER_CRITICAL();
+    gap = tick_gap_max;
+    taskEXIT_CRITICAL();
+
+    return gap * US_PER_COUNT;
+}
@@ -0,0 +1,42 @@
+#ifndef SYSMON_H
+#define SYSMON_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mesure de charge CPU basée sur l'idle hook et le Timer1 du tick FreeRTOS.
+// vApplicationIdleHook() et vApplicationTickHook() sont définis dans sysmon.c.
+
+// Dernières valeurs calculées par sysmon_update() (page I2C "stats")
+typedef struct
+{
+    uint8_t  cpu_load_1s;           // %
+    uint8_t  cpu_load_60s;          // %
+    uint16_t tick_gap_max_us;       // Little-endian
+} sysmon_stats_t;
+
+volatile sysmon_stats_t *sysmon_stats(void);
+
+void     sysmon_update(void);          // Calcule les moyennes (à appeler depuis une tâche)
+uint8_t  sysmon_cpu_load_1s(void);     // Charge CPU sur la dernière seconde (0-100 %)
+uint8_t  sysmon_cpu_load_60s(void);    // Moyenne glissante sur ~60 s (0-100 %)
+uint16_t sysmon_tick_gap_max(void);    // Pire écart observé entre deux ticks (µs)
+
+// Base de temps 32 bits en millisecondes : le compteur de ticks FreeRTOS est
+// sur 16 bits (configUSE_16_BIT_TICKS) et reboucle toutes les 65,5 s, le tick
+// hook compte ses débordements. Utilisable en tâche comme sous interruption.
+uint32_t sysmon_uptime_ms(void);
+
+// Horodatage fin (pas de 4 µs depuis le démarrage, reboucle après ~4,8 h)
+// d'une valeur de TCNT1 lue ou capturée (ICR1) il y a moins d'un tick.
+// A appeler sous interruption, interruptions masquées.
+uint32_t sysmon_timer_timestamp(uint8_t counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
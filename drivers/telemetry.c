@@ -0,0 +1,123 @@
+#include "telemetry.h"
+
+#if TELEMETRY_ENABLE
+
+#include <string.h>
+#include <util/crc16.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+
+#include "sysmon.h"
+#include "uart.h"
+
+#define HEADER_SIZE     5                                   // type + uptime
+#define RECORD_MAX      (HEADER_SIZE + TELEMETRY_MAX_DATA)
+#define FRAME_MAX       (RECORD_MAX + 1 + 2)                // CRC, code COBS, délimiteur
+
+static MessageBufferHandle_t buffer;
+static uint8_t lost = 0;
+static uint8_t lost_reported = 0;
+
+// Utilisés par la seule tâche télémétrie
+static uint8_t record[RECORD_MAX + 1];
+static uint8_t frame[FRAME_MAX];
+
+void telemetry_init(uint32_t baud)
+{
+    buffer = xMessageBufferCreate(TELEMETRY_BUFFER_SIZE);
+    uart_init(baud);
+}
+
+static void put_header(uint8_t *dst, uint8_t type)
+{
+    uint32_t now = sysmon_uptime_ms();
+
+    dst[0] = type;
+    memcpy(&dst[1], &now, sizeof(now));
+}
+
+void telemetry_push_event(uint8_t event, uint8_t value)
+{
+    // Sur la pile de l'appelant (tâches à 80 octets de pile) : juste un
+    // enregistrement TLM_EVENT
+    uint8_t pushed[HEADER_SIZE + 2];
+    put_header(pushed, TLM_EVENT);
+    pushed[HEADER_SIZE] = event;
+    pushed[HEADER_SIZE + 1] = value;
+
+    // Un message buffer n'accepte qu'un écrivain à la fois
+    taskENTER_CRITICAL();
+    if (xMessageBufferSend(buffer, pushed, sizeof(pushed), 0) == 0)
+        lost++;
+    taskEXIT_CRITICAL();
+}
+
+// COBS : chaque 0x00 est remplacé par la distance au suivant, la trame ne
+// contient plus de 0x00 que son délimiteur final (enregistrements < 254 octets)
+static uint8_t cobs_encode(const uint8_t *src, uint8_t length, uint8_t *dst)
+{
+    uint8_t code_at = 0;
+    uint8_t code = 1;
+    uint8_t out = 1;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (src[i] == 0)
+        {
+            dst[code_at] = code;
+            code_at = out++;
+            code = 1;
+        }
+        else
+        {
+            dst[out++] = src[i];
+            code++;
+        }
+    }
+    dst[code_at] = code;
+    dst[out++] = 0;
+    return out;
+}
+
+static void send_record(uint8_t length)
+{
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < length; i++)
+        crc = _crc8_ccitt_update(crc, record[i]);
+    record[length++] = crc;
+
+    uart_write(frame, cobs_encode(record, length, frame));
+}
+
+void telemetry_send(uint8_t type, const void *data, uint8_t length)
+{
+    if (length > TELEMETRY_MAX_DATA)
+        length = TELEMETRY_MAX_DATA;
+
+    put_header(record, type);
+    memcpy(&record[HEADER_SIZE], data, length);
+    send_record(HEADER_SIZE + length);
+}
+
+uint8_t telemetry_send_next(uint16_t wait)
+{
+    // Pertes signalées dans le flux dès que le message buffer a de la place
+    if (lost != lost_reported)
+    {
+        lost_reported = lost;
+        telemetry_send(TLM_LOST, &lost_reported, 1);
+        return 1;
+    }
+
+    uint8_t length = xMessageBufferReceive(buffer, record, RECORD_MAX, wait);
+    if (length == 0)
+        return 0;
+
+    send_record(length);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Télémétrie poussée sur la liaison série USB, en plus de l'I2C (compilée
+// avec `make TELEMETRY=1`). Les tâches déposent des enregistrements dans un
+// message buffer FreeRTOS, la tâche télémétrie les envoie en trames :
+//   [type][uptime ms, 32 bits LE][données][CRC-8 poly 0x07]
+// encodées en COBS et terminées par un octet 0x00.
+
+#ifndef TELEMETRY_ENABLE
+#define TELEMETRY_ENABLE    0
+#endif
+
+#define TELEMETRY_BAUD_DEFAULT  1000000UL
+#define TELEMETRY_BUFFER_SIZE   96      // Message buffer (octets, longueurs comprises)
+#define TELEMETRY_MAX_DATA      40
+
+// Types d'enregistrements
+#define TLM_EVENT           1       // [type d'événement][valeur] (voir event_log.h)
+#define TLM_STATE           2       // Banque de registres de la page 0
+#define TLM_LOST            3       // [enregistrements perdus, message buffer plein (modulo 256)]
+
+#if TELEMETRY_ENABLE
+
+void    telemetry_init(uint32_t baud);
+
+// Dépose un enregistrement TLM_EVENT, sans attendre : perdu et compté si le
+// message buffer est plein. Utilisable depuis n'importe quelle tâche.
+void    telemetry_push_event(uint8_t event, uint8_t value);
+
+// Réservées à la tâche télémétrie : envoi direct d'un enregistrement, ou
+// attente d'un enregistrement déposé au plus `wait` ticks puis envoi.
+// telemetry_send_next() retourne 0 si rien n'est arrivé.
+void    telemetry_send(uint8_t type, const void *data, uint8_t length);
+uint8_t telemetry_send_next(uint16_t wait);
+
+#else
+
+static inline void telemetry_push_event(uint8_t event, uint8_t value)
+{
+    (void)event; (void)value;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "soft_i2c.h"
+#include "telemetry.h"
+
+#define COUNTS_PER_TICK     250     // Timer1 du tick FreeRTOS (voir sysmon.c)
+#define BATCH_HEADER_SIZE   2
+#define BATCH_MAX_EVENTS    ((32 - BATCH_HEADER_SIZE) / sizeof(trace_event_t))
+#define BATCH_MORE          0x80
+
+volatile uint8_t trace_tick = 0;    // Poids faible du compteur de ticks (traceTASK_INCREMENT_TICK)
+
+static trace_event_t ring[TRACE_SIZE];
+static uint8_t head = 0;
+static uint8_t filled = 0;          // Evénements valides dans l'anneau
+static uint8_t overwritten = 0;
+static uint8_t recording = 1;
+static uint8_t dumping = 0;
+static uint8_t dump_tail = 0;
+
+// Appelé par les macros de trace du noyau (souvent déjà en section
+// critique) et par les ISR : on masque quand même, vTaskDelay() trace
+// avec les interruptions actives.
+void trace_record(uint8_t code)
+{
+    uint8_t sreg = SREG;
+    cli();
+
+    if (recording)
+    {
+        uint8_t count = TCNT1L;
+        uint8_t tick = trace_tick;
+
+        // Comparaison atteinte, tick pas encore traité (même cas que l'idle hook)
+        if ((TIFR1 & _BV(OCF1A)) && count < COUNTS_PER_TICK / 2)
+            tick++;
+
+        trace_event_t *e = &ring[head & (TRACE_SIZE - 1)];
+        e->code = code;
+        e->time = tick * COUNTS_PER_TICK + count;
+        head++;
+
+        if (filled < TRACE_SIZE)
+            filled++;
+        else
+            overwritten = 1;
+    }
+
+    SREG = sreg;
+}
+
+// Appelé depuis requestEvent() (ISR TWI, interruptions masquées)
+void trace_send_batch(void)
+{
+    uint8_t header[BATCH_HEADER_SIZE];
+
+    if (!dumping)
+    {
+        recording = 0;
+        dumping = 1;
+        dump_tail = head - filled;
+    }
+
+    uint8_t pending = head - dump_tail;
+    uint8_t count = pending > BATCH_MAX_EVENTS ? BATCH_MAX_EVENTS : pending;
+
+    header[0] = count | (pending > count ? BATCH_MORE : 0);
+    header[1] = (overwritten ? TRACE_DUMP_OVERWRITTEN : 0)
+              | (TELEMETRY_ENABLE ? TRACE_DUMP_TELEMETRY : 0);
+    soft_i2c_write(header, sizeof(header));
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        soft_i2c_write((const uint8_t *)&ring[dump_tail & (TRACE_SIZE - 1)], sizeof(trace_event_t));
+        dump_tail++;
+    }
+
+    if (pending == count)
+    {
+        filled = 0;
+        overwritten = 0;
+        dumping = 0;
+        recording = 1;
+    }
+}
+
+#endif
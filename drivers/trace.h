@@ -0,0 +1,85 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Enregistreur d'événements du noyau : commutations de tâches, ISR,
+// sémaphores, mises en attente, dans un anneau en RAM relu par le master.
+// Compilé seulement avec `make TRACE=1` (TRACE_ENABLE) : sinon les macros
+// de trace de FreeRTOSConfig.h et TRACE_ISR_* sont vides.
+//
+// Chaque événement fait 3 octets : code (type | argument) et horodatage
+// 16 bits au pas de 4 µs, (tick % 256) * 250 + TCNT1, qui reboucle toutes
+// les 256 ms (64000 pas). L'anneau garde les TRACE_SIZE derniers événements.
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        0
+#endif
+
+#define TRACE_SIZE          64      // Nombre d'événements (puissance de 2)
+#define TRACE_TIME_WRAP     64000U  // Période de l'horodatage, en pas de 4 µs
+
+// Types (poids fort du code), l'argument est dans le poids faible
+#define TRACE_SWITCH_IN     0x10    // arg = tâche (ordre de création, 1 = première)
+#define TRACE_ISR_ENTER     0x20    // arg = TRACE_ISR_*
+#define TRACE_ISR_EXIT      0x30
+#define TRACE_GIVE          0x40    // arg = numéro de file (vQueueSetQueueNumber)
+#define TRACE_TAKE          0x50
+#define TRACE_BLOCK         0x60    // La tâche courante attend la file arg
+#define TRACE_DELAY         0x70    // arg = tâche qui s'endort (vTaskDelay/vTaskDelayUntil)
+#define TRACE_ARG_MASK      0x0F
+
+// Interruptions instrumentées
+#define TRACE_ISR_TWI       1
+#define TRACE_ISR_CAPTURE   2
+#define TRACE_ISR_PCINT     3
+
+// Files nommées
+#define TRACE_QUEUE_LCD     1
+
+// Octet 1 des lots : options de la trace. Les tâches sont numérotées dans
+// l'ordre de création de main(), qui dépend de la compilation.
+#define TRACE_DUMP_OVERWRITTEN  0x01    // Des événements plus anciens ont été écrasés
+#define TRACE_DUMP_TELEMETRY    0x02    // Tâche TLM créée (TELEMETRY=1), avant IDLE
+
+// Evénement tel qu'envoyé sur le bus (little-endian)
+typedef struct
+{
+    uint8_t  code;
+    uint16_t time;
+} trace_event_t;
+
+#if TRACE_ENABLE
+
+extern volatile uint8_t trace_tick;
+
+// Ajoute un événement (tâche ou interruption)
+void trace_record(uint8_t code);
+
+// Envoie un lot au master (à enregistrer avec soft_i2c_add_stream_page) :
+//   octet 0 : bits 0-6 = nombre d'événements du lot, bit 7 = il en reste
+//   octet 1 : TRACE_DUMP_*
+//   puis jusqu'à 10 événements de 3 octets
+// Le premier lot fige l'anneau ; l'enregistrement reprend, anneau vide,
+// une fois le dernier lot envoyé.
+void trace_send_batch(void);
+
+#define TRACE_ISR_BEGIN(id) trace_record(TRACE_ISR_ENTER | (id))
+#define TRACE_ISR_END(id)   trace_record(TRACE_ISR_EXIT | (id))
+
+#else
+
+#define TRACE_ISR_BEGIN(id)
+#define TRACE_ISR_END(id)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+#include "traffic.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "sysmon.h"
+#include "pin.h"
+#include "trace.h"
+
+#define BEAM_A          0
+#define BEAM_B          1
+
+typedef Pin<PortB, PB0> BeamA;  // ICP1
+typedef Pin<PortB, PB1> BeamB;  // PCINT1
+
+#define EDGE_FIFO_SIZE  8           // Puissance de 2
+#define STEPS_PER_S     250000UL    // Pas de 4 µs
+
+typedef struct
+{
+    uint32_t time;                  // sysmon_timer_timestamp()
+    uint8_t  beam;
+    uint8_t  blocked;
+} edge_t;
+
+enum { IDLE, A_FIRST, B_FIRST, CROSSED };
+
+static volatile traffic_stats_t stats;
+
+// FIFO remplie par les ISR, vidée par traffic_process()
+static edge_t edges[EDGE_FIFO_SIZE];
+static volatile uint8_t edge_head = 0;
+static volatile uint8_t edge_tail = 0;
+static volatile uint8_t beam_b_level = 1;
+
+static uint8_t  state = IDLE;
+static uint32_t first_time;
+static uint8_t  blocked[2];
+
+// Appelé sous interruption
+static void push_edge(uint8_t beam, uint8_t is_blocked, uint32_t time)
+{
+    uint8_t next = (edge_head + 1) & (EDGE_FIFO_SIZE - 1);
+
+    if (next == edge_tail)
+    {
+        stats.edges_lost++;
+        return;
+    }
+    edges[edge_head].time = time;
+    edges[edge_head].beam = beam;
+    edges[edge_head].blocked = is_blocked;
+    edge_head = next;
+}
+
+// Faisceau A : ICR1 a figé TCNT1 au front, on capture ensuite le front opposé
+ISR(TIMER1_CAPT_vect)
+{
+    TRACE_ISR_BEGIN(TRACE_ISR_CAPTURE);
+    uint8_t counts = (uint8_t)ICR1;
+    uint8_t falling = !(TCCR1B & _BV(ICES1));   // FC-51 : niveau bas = faisceau coupé
+    uint8_t now_blocked = !BeamA::read();
+
+    // Front suivant choisi d'après le niveau actuel : un rebond plus court
+    // que la latence de l'interruption ne désynchronise pas la capture
+    if (now_blocked)
+        TCCR1B |= _BV(ICES1);
+    else
+        TCCR1B &= ~_BV(ICES1);
+    TIFR1 = _BV(ICF1);      // Changer de front peut lever ICF1
+
+    push_edge(BEAM_A, falling, sysmon_timer_timestamp(counts));
+    if (now_blocked != falling)
+        push_edge(BEAM_A, now_blocked, sysmon_timer_timestamp((uint8_t)TCNT1));
+    TRACE_ISR_END(TRACE_ISR_CAPTURE);
+}
+
+// Faisceau B : TCNT1 lu dès l'entrée de l'interruption
+ISR(PCINT0_vect)
+{
+    uint8_t counts = (uint8_t)TCNT1;
+    uint8_t level = BeamB::read();
+
+    TRACE_ISR_BEGIN(TRACE_ISR_PCINT);
+    if (level != beam_b_level)
+    {
+        beam_b_level = level;
+        push_edge(BEAM_B, !level, sysmon_timer_timestamp(counts));
+    }
+    TRACE_ISR_END(TRACE_ISR_PCINT);
+}
+
+volatile traffic_stats_t *traffic_stats(void)
+{
+    return &stats;
+}
+
+void traffic_init(void)
+{
+    // Faisceaux en entrée avec pull-up (PB0 est déjà configuré par ir_init)
+    BeamA::pullup();
+    BeamB::pullup();
+
+    taskENTER_CRITICAL();
+    blocked[BEAM_A] = !BeamA::read();
+    blocked[BEAM_B] = !BeamB::read();
+    beam_b_level = !blocked[BEAM_B];
+
+    // Capture d'entrée : filtre anti-bruit (4 cycles), front descendant ou
+    // montant selon l'état actuel du faisceau
+    TCCR1B |= _BV(ICNC1);
+    if (blocked[BEAM_A])
+        TCCR1B |= _BV(ICES1);
+    else
+        TCCR1B &= ~_BV(ICES1);
+    TIFR1 = _BV(ICF1);
+    TIMSK1 |= _BV(ICIE1);
+
+    PCMSK0 |= _BV(PCINT1);
+    PCIFR = _BV(PCIF0);
+    PCICR |= _BV(PCIE0);
+    taskEXIT_CRITICAL();
+}
+
+static uint8_t crossed(uint8_t direction, uint32_t gap, uint16_t spacing_mm)
+{
+    // cm/s = mm * 250000 / 10 / pas
+    uint32_t speed = gap ? (uint32_t)spacing_mm * (STEPS_PER_S / 10) / gap : 0;
+
+    taskENTER_CRITICAL();
+    if (direction == TRAFFIC_ENTER)
+    {
+        stats.entries++;
+        stats.occupied++;
+    }
+    else
+    {
+        stats.exits++;
+        if (stats.occupied)
+            stats.occupied--;
+    }
+    stats.last_speed_cms = speed > 0xFFFF ? 0xFFFF : speed;
+    stats.last_direction = direction;
+    taskEXIT_CRITICAL();
+
+    return direction;
+}
+
+uint8_t traffic_process(uint16_t spacing_mm)
+{
+    uint8_t result = 0;
+
+    while (edge_tail != edge_head)
+    {
+        edge_t e;
+
+        taskENTER_CRITICAL();
+        e = edges[edge_tail];
+        edge_tail = (edge_tail + 1) & (EDGE_FIFO_SIZE - 1);
+        taskEXIT_CRITICAL();
+
+        blocked[e.beam] = e.blocked;
+
+        switch (state)
+        {
+        case IDLE:
+            if (e.blocked)
+            {
+                state = e.beam == BEAM_A ? A_FIRST : B_FIRST;
+                first_time = e.time;
+            }
+            break;
+
+        case A_FIRST:
+        case B_FIRST:
+            if (e.blocked && e.beam != (state == A_FIRST ? BEAM_A : BEAM_B))
+            {
+                // Second faisceau coupé : le sens est connu
+                result = crossed(state == A_FIRST ? TRAFFIC_ENTER : TRAFFIC_EXIT,
+                                 e.time - first_time, spacing_mm);
+                state = CROSSED;
+            }
+            else if (!blocked[BEAM_A] && !blocked[BEAM_B])
+            {
+                // Demi-tour avant le second faisceau
+                taskENTER_CRITICAL();
+                stats.aborted++;
+                taskEXIT_CRITICAL();
+                state = IDLE;
+            }
+            break;
+
+        case CROSSED:
+            // Attendre que la voiture ait libéré les deux faisceaux
+            if (!blocked[BEAM_A] && !blocked[BEAM_B])
+                state = IDLE;
+            break;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,46 @@
+#ifndef TRAFFIC_H
+#define TRAFFIC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sens de passage à l'entrée avec deux faisceaux IR espacés :
+//   A -> PB0 (D8, ICP1) côté rue, horodaté par la capture d'entrée du Timer1
+//   B -> PB1 (D9, PCINT1) côté parking, horodaté dans l'interruption
+// Les fronts sont datés au pas de 4 µs (Timer1 du tick FreeRTOS). Une
+// voiture qui coupe A puis B entre, B puis A sort ; l'écart entre les deux
+// coupures donne la vitesse.
+
+#define TRAFFIC_ENTER       1
+#define TRAFFIC_EXIT        2
+
+// Page I2C "traffic", little-endian
+typedef struct
+{
+    uint16_t occupied;              // Places occupées (entrées - sorties, depuis le démarrage)
+    uint16_t entries;
+    uint16_t exits;
+    uint16_t aborted;               // Faisceau coupé puis libéré sans traverser
+    uint16_t last_speed_cms;        // Vitesse du dernier passage (cm/s)
+    uint8_t  last_direction;        // TRAFFIC_ENTER / TRAFFIC_EXIT
+    uint8_t  edges_lost;            // FIFO des fronts pleine (modulo 256)
+} traffic_stats_t;
+
+volatile traffic_stats_t *traffic_stats(void);
+
+// Arme la capture : à appeler depuis une tâche, une fois le scheduler lancé
+// (le port FreeRTOS réécrit TCCR1B en démarrant le tick)
+void    traffic_init(void);
+
+// Traite les fronts reçus depuis le dernier appel. Retourne TRAFFIC_ENTER ou
+// TRAFFIC_EXIT si un passage vient d'être reconnu, 0 sinon.
+uint8_t traffic_process(uint16_t spacing_mm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
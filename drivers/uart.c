@@ -0,0 +1,45 @@
+#include "uart.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+static const uint8_t *volatile tx_data;
+static volatile uint8_t tx_left = 0;
+static TaskHandle_t tx_task = NULL;
+
+void uart_init(uint32_t baud)
+{
+    UBRR0 = F_CPU / 8 / baud - 1;
+    UCSR0A = _BV(U2X0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);    // 8N1
+    UCSR0B = _BV(TXEN0);
+}
+
+void uart_write(const uint8_t *data, uint8_t length)
+{
+    if (length == 0)
+        return;
+
+    tx_task = xTaskGetCurrentTaskHandle();
+    taskENTER_CRITICAL();
+    tx_data = data;
+    tx_left = length;
+    UCSR0B |= _BV(UDRIE0);
+    taskEXIT_CRITICAL();
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+// Registre d'émission libre : octet suivant, réveil de la tâche au dernier
+ISR(USART_UDRE_vect)
+{
+    UDR0 = *tx_data++;
+    if (--tx_left == 0)
+    {
+        UCSR0B &= ~_BV(UDRIE0);
+        vTaskNotifyGiveFromISR(tx_task, NULL);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// USART0 en émission seule (TX sur D1, relié au convertisseur USB de la
+// carte), 8N1. Les octets partent sous interruption depuis le tampon de
+// l'appelant : une interruption courte par octet, pas d'attente active.
+
+// Débit jusqu'à 1 Mbaud (U2X : UBRR = F_CPU / 8 / baud - 1, exact à 1M, 500k, 250k)
+void uart_init(uint32_t baud);
+
+// Envoie `length` octets et bloque la tâche appelante jusqu'au dernier.
+// Une seule tâche émettrice (voir telemetry.c).
+void uart_write(const uint8_t *data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,9 +3,12 @@
 Master I2C pour communiquer avec l'Arduino Uno (slave I2C)
 Ce script permet de récupérer l'état du système de parking depuis l'Arduino
 Basé sur l'implémentation soft_i2c avec système de registres
+Le lien avec le firmware passe par un transport choisi par URL (voir open_link) :
+bus I2C, télémétrie série ou firmware simulé
 """
 
-import smbus2
+import collections
+import threading
 import time
 import argparse
 
@@ -22,112 +25,1786 @@ REG_RELEASE_COUNTER = 4  # Compteur de release (0-40)
 REG_SYSTEM_STATUS = 5  # Status général du système
 REG_SERVO_COMMAND = 6  # Commande manuelle servo
 REG_CHANGE_FLAG = 7    # Flag indiquant si données ont changé (1=changé, 0=stable)
+REG_CPU_LOAD_1S = 8    # Charge CPU sur la dernière seconde (%)
+REG_CPU_LOAD_60S = 9   # Charge CPU moyenne sur ~60 s (%)
+REG_TICK_GAP_MAX_L = 10  # Pire écart tick-à-tick en µs (octet bas)
+REG_TICK_GAP_MAX_H = 11  # Pire écart tick-à-tick en µs (octet haut)
+REG_HEARTBEAT = 12     # Incrémenté quand toutes les tâches du firmware ont répondu
+REG_RESET_CAUSE = 13   # MCUSR au démarrage (bit0=POR, bit1=EXT, bit2=BOR, bit3=WDT, bit7=pile)
+REG_REBOOT_COUNT = 14  # Redémarrages depuis la mise sous tension
+REG_HOLD_POLICY = 15   # Politique de maintien de la barrière (voir HOLD_POLICIES)
+REG_UPTIME_0 = 16      # Uptime firmware en ms (32 bits LE, 16-19), lire 16 fige la valeur
+REG_LAST_CHANGE_0 = 20  # Uptime du dernier changement d'état (32 bits LE, 20-23)
+REG_EVENT_FIFO = 24    # FIFO des événements horodatés (un lot par lecture en rafale, acquitté par écriture)
+REG_JOURNAL_STREAM = 25  # Relecture du journal EEPROM (un lot par lecture en rafale)
+REG_JOURNAL_CTRL = 26  # Ecrire 1 pour rembobiner la relecture du journal
+REG_JOURNAL_COUNT = 27  # Nombre d'enregistrements dans le journal EEPROM
+REG_PARAM_ID = 28      # Fenêtre paramètres : identifiant, valeur (29-30 LE), commande (31)
+REG_PARAM_CTRL = 31    # Commande PARAM_CMD_*, remise à 0 par le firmware une fois faite
+REG_OCCUPANCY_L = 32   # Bitmap d'occupation, bit n = place n occupée (16 bits LE, 32-33)
+REG_SPOT_COUNT = 34    # Nombre de places gérées par le firmware
+REG_FREE_SPOTS = 35    # Places libres depuis au moins barrier_hold_ms
+REG_STATUS_FRAME = 36  # Instantané du status avec PEC, lu en une rafale (voir status_frame)
+STATUS_FRAME_SIZE = 19  # seq, registres 0-5, occupation (2), places libres, uptime, dernier changement, PEC
+STATUS_FRAME_RETRIES = 3
+
+# Pages de registres : écrire la page dans REG_PAGE_SELECT, la page 0 est
+# la carte ci-dessus
+REG_PAGE_SELECT = 0xFF
+PAGE_STATUS = 0
+PAGE_CONFIG = 1        # Valeurs des paramètres en vigueur (16 bits LE, ordre des identifiants)
+PAGE_STATS = 2         # Charge CPU 1 s, 60 s, pire écart tick-à-tick (16 bits LE)
+PAGE_EVENTS = 3        # Même flux que REG_EVENT_FIFO
+PAGE_JOURNAL = 4       # Même flux que REG_JOURNAL_STREAM
+PAGE_POLICY = 5        # Compteurs par politique de maintien
+PAGE_TRAFFIC = 6       # Comptage entrées/sorties par les deux faisceaux
+PAGE_APPROACH = 7      # Pré-ouverture : temps d'attente et de dégagement par voiture
+PAGE_OCCUPANCY = 8     # Statistiques d'occupation (rafale de 32 octets)
+PAGE_OCCUPANCY_RESET = 9  # Écrire [séquence][génération] d'une rafale vérifiée pour remettre ses compteurs à zéro
+OCCUPANCY_BINS = 12    # Histogramme des durées : <1 min, 1, 2-3, 4-7, ... , >= 1024 min
+OCCUPANCY_RETRIES = 4  # Lectures de la page 8 avant d'abandonner
+PAGE_PROGRAM = 10      # Programme de la barrière : ctrl, status, pc, boucles restantes, code
+PAGE_TRACE = 11        # Trace du noyau, firmware compilé avec make TRACE=1 (voir drivers/trace.h)
+PAGE_BUS = 12          # Compteurs I2C côté esclave (16 bits LE, voir drivers/soft_i2c.h)
+BUS_COUNTERS = ['writes', 'reads', 'bytes_in', 'bytes_out', 'overruns', 'bus_errors', 'invalid',
+                'isr_max_us', 'slow_isr']
+ISR_BUDGET_US = 100    # SOFT_I2C_ISR_BUDGET_US : étirement d'horloge maximal visé côté esclave
+
+# Sonde de débit (probe_speed) : nom, registre, octets lus (0 = écriture de la page 0)
+SPEED_WORKLOADS = [
+    ('status', REG_SYSTEM_STATUS, 1),
+    ('uptime', REG_UPTIME_0, 8),
+    ('bank', 0, 32),
+    ('page_select', REG_PAGE_SELECT, 0),
+]
+PAGE_SPOT_0 = 0x10     # État de la place n en page PAGE_SPOT_0 + n
+SPOT_PAGE_SIZE = 10    # car, released, release_counter, -, arrivals (16 bits), last_change_ms (32 bits)
+
+# Valeurs de REG_SYSTEM_STATUS
+SYS_STATUS_OK = 0x01       # Toutes les tâches ont répondu au dernier cycle
+SYS_STATUS_STALLED = 0x02  # Au moins une tâche n'a pas répondu
+SYS_STATUS_BOOTING = 0x80  # I2C actif, tâches en cours de démarrage
+
+# Supervision du heartbeat
+HEARTBEAT_PERIOD = 0.25     # Période du heartbeat côté firmware (secondes)
+HEARTBEAT_STALL_POLLS = 2   # Lectures consécutives sans progression avant alerte
+
+RESET_CAUSES = {0x01: 'POR', 0x02: 'EXT', 0x04: 'BOR', 0x08: 'WDT', 0x80: 'STACK'}
+
+# Journal d'événements (voir drivers/event_log.h)
+EVENT_BATCH_SIZE = 32      # 3 octets d'en-tête + 4 enregistrements de 6 octets
+EVENT_BATCH_HEADER = 3
+EVENT_RECORD_SIZE = 6
+EVENT_RETRIES = 3          # Relectures d'un lot en erreur avant d'abandonner
+EVENT_TYPES = {1: 'car', 2: 'light', 3: 'barrier', 4: 'led', 5: 'mode', 6: 'direction'}
+TRAFFIC_DIRECTIONS = {1: 'entrée', 2: 'sortie'}
+
+# Journal EEPROM (voir drivers/journal.h)
+JOURNAL_CMD_REWIND = 1
+JOURNAL_BATCH_SIZE = 25    # 1 octet d'en-tête + 3 enregistrements de 8 octets
+JOURNAL_RECORD_SIZE = 8
+JOURNAL_STATE_BITS = {
+    'car_detected': 0x01, 'is_dark': 0x02, 'barrier_open': 0x04, 'manual_mode': 0x08,
+    'led_red': 0x10, 'led_green': 0x20, 'led_white': 0x40
+}
+
+# Paramètres réglables (voir drivers/params.h) : nom -> (identifiant, min, max)
+PARAMS = {
+    'barrier_hold_ms': (0, 50, 12750),
+    'open_angle': (1, 1, 180),
+    'ir_period_ms': (2, 10, 200),
+    'light_period_ms': (3, 10, 200),
+    'led_period_ms': (4, 10, 200),
+    'i2c_address': (5, 0x08, 0x77),     # Pris en compte au prochain démarrage
+    'hold_policy': (6, 0, 1),           # Politique au démarrage
+    'rush_gap_ms': (7, 1000, 60000),
+    'rush_hold_ms': (8, 50, 12750),
+    'short_hold_ms': (9, 50, 12750),
+    'beam_spacing_mm': (10, 50, 2000),
+    'preopen_angle': (11, 0, 180),
+    'preopen_timeout_ms': (12, 500, 60000),
+    'servo_ms_per_deg': (13, 1, 50),
+}
+
+# Politiques de maintien de la barrière (voir drivers/hold_policy.h)
+HOLD_POLICIES = {'fixed': 0, 'adaptive': 1}
+PARAM_CMD_READ = 1
+PARAM_CMD_WRITE = 2
+PARAM_CMD_COMMIT = 3
+PARAM_CMD_DEFAULTS = 4
+PARAM_CMD_ERROR = 0x80
+
+# Trace du noyau : événements de 3 octets [type | arg][horodatage 16 bits LE, pas de 4 µs]
+TRACE_RECORD_SIZE = 3
+TRACE_TIME_WRAP = 64000
+TRACE_US_PER_COUNT = 4
+TRACE_TYPES = {0x1: 'switch', 0x2: 'isr_enter', 0x3: 'isr_exit', 0x4: 'give',
+               0x5: 'take', 0x6: 'block', 0x7: 'delay'}
+TRACE_TASKS = ['IR', 'SERV', 'LED', 'LGT', 'JRNL', 'SUP']  # Ordre de création dans main()
+TRACE_DUMP_OVERWRITTEN = 0x01  # Octet 1 des lots
+TRACE_DUMP_TELEMETRY = 0x02    # Tâche 'TLM' créée après les autres (make TELEMETRY=1)
+TRACE_ISRS = {1: 'TWI', 2: 'CAPT', 3: 'PCINT'}
+TRACE_QUEUES = {1: 'lcdSem'}
+
+# Télémétrie série (firmware compilé avec make TELEMETRY=1, voir drivers/telemetry.h)
+TELEMETRY_PORT = '/dev/ttyACM0'
+TELEMETRY_BAUD = 1000000
+TLM_EVENT = 1
+TLM_STATE = 2
+TLM_LOST = 3
+
+
+def decode_trace(records, telemetry=False):
+    """
+    Déroule les horodatages de la trace du noyau (rebouclage toutes les
+    256 ms : deux événements consécutifs doivent être plus proches)
+
+    Args:
+        records: Liste de (code, horodatage brut) dans l'ordre du firmware
+        telemetry: Firmware compilé avec la tâche TLM (TRACE_DUMP_TELEMETRY)
+
+    Returns:
+        Liste de dicts time_us (depuis le premier événement), type et name
+    """
+    tasks = TRACE_TASKS + (['TLM'] if telemetry else []) + ['IDLE']
+    events = []
+    time_us = 0
+    prev = None
+    for code, raw in records:
+        if prev is not None:
+            time_us += ((raw - prev) % TRACE_TIME_WRAP) * TRACE_US_PER_COUNT
+        prev = raw
+
+        kind = TRACE_TYPES.get(code >> 4, code >> 4)
+        arg = code & 0x0F
+        if kind in ('switch', 'delay'):
+            name = tasks[arg - 1] if 0 < arg <= len(tasks) else f"task{arg}"
+        elif kind in ('isr_enter', 'isr_exit'):
+            name = TRACE_ISRS.get(arg, f"isr{arg}")
+        else:
+            name = TRACE_QUEUES.get(arg, f"queue{arg}")
+        events.append({'time_us': time_us, 'type': kind, 'name': name})
+    return events
+
+
+def trace_statistics(events):
+    """
+    Calcule la chronologie par tâche et les latences à partir d'une trace
+    décodée
+
+    Returns:
+        Dict avec 'timeline' (tâche, début, durée en µs), 'tasks' (par tâche :
+        nombre d'exécutions, temps total, plus longue exécution, part du temps
+        tracé), 'isrs' (par ISR : nombre, durée moyenne et maximale) et
+        'queues' (par file : délai entre give et take suivant)
+    """
+    timeline, tasks, isrs, queues = [], {}, {}, {}
+    running, since = None, None
+    isr_start = {}
+    given = {}
+
+    for e in events:
+        t = e['time_us']
+        if e['type'] == 'switch':
+            if running is not None:
+                timeline.append((running, since, t - since))
+            running, since = e['name'], t
+        elif e['type'] == 'isr_enter':
+            isr_start[e['name']] = t
+        elif e['type'] == 'isr_exit' and e['name'] in isr_start:
+            isrs.setdefault(e['name'], []).append(t - isr_start.pop(e['name']))
+        elif e['type'] == 'give':
+            given.setdefault(e['name'], t)
+        elif e['type'] == 'take' and e['name'] in given:
+            queues.setdefault(e['name'], []).append(t - given.pop(e['name']))
+
+    span = timeline[-1][1] + timeline[-1][2] - timeline[0][1] if timeline else 0
+    for name, start, duration in timeline:
+        stats = tasks.setdefault(name, {'runs': 0, 'total_us': 0, 'max_us': 0})
+        stats['runs'] += 1
+        stats['total_us'] += duration
+        stats['max_us'] = max(stats['max_us'], duration)
+    for stats in tasks.values():
+        stats['share_pct'] = stats['total_us'] * 100 / span if span else 0
+
+    def summary(samples):
+        return {'count': len(samples), 'avg_us': sum(samples) / len(samples), 'max_us': max(samples)}
+
+    return {
+        'timeline': timeline,
+        'tasks': tasks,
+        'isrs': {name: summary(d) for name, d in isrs.items()},
+        'queues': {name: summary(d) for name, d in queues.items()}
+    }
+
+
+# Programmes de la barrière (voir drivers/barrier_prog.h) : nom -> (opcode, taille des arguments)
+PROG_OPCODES = {'end': (0x00, []), 'move': (0x01, [1]), 'wait': (0x02, [2]),
+                'wait_car': (0x03, [1]), 'loop': (0x04, [1, 1]), 'auto': (0x05, [])}
+PROG_CODE_OFFSET = 4
+PROG_CODE_SIZE = 28
+PROG_CMD_RUN = 1
+PROG_CMD_STOP = 2
+PROG_STATUS = {0: 'inactif', 1: 'en cours', 2: 'terminé', 3: 'arrêté', 0x80: 'erreur'}
+
+
+def assemble_program(text):
+    """
+    Traduit un programme texte en code pour la page program, par exemple
+    "move 120; wait 30000; auto" ou "move 0; wait 1000; move 120; wait 1000;
+    loop 0 9; auto". La cible de loop est le numéro d'instruction (à partir
+    de 0), convertie ici en adresse dans le code.
+
+    Returns:
+        Liste d'octets ; lève ValueError si le programme est invalide
+    """
+    steps = [line.split() for line in text.replace('\n', ';').split(';') if line.strip()]
+    offsets = []
+    size = 0
+    for step in steps:
+        if step[0] not in PROG_OPCODES:
+            raise ValueError(f"instruction inconnue : {step[0]}")
+        offsets.append(size)
+        size += 1 + sum(PROG_OPCODES[step[0]][1])
+
+    code = []
+    for step in steps:
+        opcode, arg_sizes = PROG_OPCODES[step[0]]
+        if len(step) - 1 != len(arg_sizes):
+            raise ValueError(f"{step[0]} attend {len(arg_sizes)} argument(s)")
+        args = [int(a, 0) for a in step[1:]]
+        if step[0] == 'loop':
+            if not 0 <= args[0] < len(offsets):
+                raise ValueError(f"cible de boucle invalide : {args[0]}")
+            args[0] = offsets[args[0]]
+        code.append(opcode)
+        for value, width in zip(args, arg_sizes):
+            if not 0 <= value < (1 << (8 * width)):
+                raise ValueError(f"argument hors limites : {value}")
+            code.extend(value.to_bytes(width, 'little'))
+
+    if not steps or steps[-1][0] not in ('end', 'auto'):
+        code.append(PROG_OPCODES['end'][0])
+    if len(code) > PROG_CODE_SIZE:
+        raise ValueError(f"programme trop long ({len(code)} octets, {PROG_CODE_SIZE} max)")
+    return code
+
+
+def crc8(data, crc=0):
+    """CRC-8 polynôme 0x07 (SMBus PEC, _crc8_ccitt_update côté AVR)"""
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def status_frame_seed(address):
+    """PEC des octets d'adresse et de registre qui précèdent la trame sur le bus"""
+    return crc8(bytes([address << 1, REG_STATUS_FRAME, (address << 1) | 1]))
+
+
+def status_frame(regs, seq, address=SLAVE_ADDRESS):
+    """
+    Construit la trame servie par le firmware à REG_STATUS_FRAME à partir
+    d'une copie des registres de la page 0 (uptime et dernier changement
+    figés, REG_UPTIME_0 à REG_LAST_CHANGE_0 + 3). Le dernier octet est le PEC
+    SMBus de la lecture : adresse + écriture, registre, adresse + lecture
+    puis les données.
+    """
+    frame = bytes([seq & 0xFF]) + bytes(regs[REG_CAR_STATE:REG_SYSTEM_STATUS + 1]) \
+        + bytes(regs[REG_OCCUPANCY_L:REG_OCCUPANCY_L + 2]) + bytes([regs[REG_FREE_SPOTS]]) \
+        + bytes(regs[REG_UPTIME_0:REG_LAST_CHANGE_0 + 4])
+    return frame + bytes([crc8(frame, status_frame_seed(address))])
+
+
+def cobs_decode(data):
+    """Décode une trame COBS (sans l'octet 0x00 final), None si elle est mal formée"""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + (1 if code == 1 else 0):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class TelemetryStream:
+    """Lecture des trames de télémétrie poussées par le firmware sur le port série USB"""
+
+    def __init__(self, port=TELEMETRY_PORT, baud=TELEMETRY_BAUD):
+        import serial   # pyserial, seulement nécessaire pour la télémétrie
+
+        # DTR reste inactif à l'ouverture : sinon l'Uno redémarre
+        self.serial = serial.Serial()
+        self.serial.port = port
+        self.serial.baudrate = baud
+        self.serial.timeout = 1.0
+        self.serial.dtr = False
+        self.serial.open()
+        self._buffer = bytearray()
+
+        self.frames = 0
+        self.corrupted = 0      # Trames rejetées (COBS ou CRC invalide)
+        self.lost = 0           # Enregistrements perdus côté firmware
+
+    def read(self):
+        """
+        Attend la trame suivante
+
+        Returns:
+            Dict décrivant l'enregistrement, ou None si rien n'est arrivé avant le timeout
+        """
+        while True:
+            end = self._buffer.find(b'\x00')
+            if end < 0:
+                chunk = self.serial.read(max(1, self.serial.in_waiting))
+                if not chunk:
+                    return None
+                self._buffer += chunk
+                continue
+
+            frame = cobs_decode(bytes(self._buffer[:end]))
+            del self._buffer[:end + 1]
+            # Type, uptime sur 4 octets et CRC au minimum
+            if frame is None or len(frame) < 6 or crc8(frame[:-1]) != frame[-1]:
+                self.corrupted += 1
+                continue
+
+            self.frames += 1
+            return self._parse(frame[0], int.from_bytes(frame[1:5], 'little'), frame[5:-1])
+
+    def pending(self):
+        """True si une trame complète attend déjà dans le buffer de réception"""
+        return 0 in self._buffer
+
+    def _parse(self, kind, uptime_ms, data):
+        record = {'uptime_ms': uptime_ms}
+        if kind == TLM_EVENT and len(data) == 2:
+            record.update(type=EVENT_TYPES.get(data[0], f'#{data[0]}'), value=data[1])
+        elif kind == TLM_STATE and len(data) > REG_FREE_SPOTS:
+            record.update(type='state', registers=bytes(data),
+                          car_detected=bool(data[REG_CAR_STATE]),
+                          is_dark=bool(data[REG_LIGHT_STATE]),
+                          servo_angle=data[REG_SERVO_ANGLE],
+                          led_state=data[REG_LED_STATE],
+                          release_counter=data[REG_RELEASE_COUNTER],
+                          system_status=data[REG_SYSTEM_STATUS],
+                          occupancy=data[REG_OCCUPANCY_L] | (data[REG_OCCUPANCY_L + 1] << 8),
+                          free_spots=data[REG_FREE_SPOTS])
+        elif kind == TLM_LOST and len(data) == 1:
+            self.lost += data[0]
+            record.update(type='lost', count=data[0])
+        else:
+            record.update(type=f'#{kind}', data=bytes(data))
+        return record
+
+    def close(self):
+        self.serial.close()
+
+
+class TransportError(OSError):
+    """Erreur de la liaison avec le firmware (NACK, timeout, opération non supportée)"""
+
+
+class LinkStats:
+    """Latence des opérations d'un transport (secondes en interne, ms en sortie)"""
+
+    SAMPLES = 256       # Fenêtre glissante pour les percentiles
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.operations = 0
+        self.errors = 0
+        self.bytes = 0
+        self.total = 0.0
+        self.worst = 0.0
+        self.last_error = None      # (heure murale, message), pour recouper avec les compteurs du firmware
+        self._samples = collections.deque(maxlen=self.SAMPLES)
+
+    def record(self, seconds, nbytes=0, error=None):
+        self.operations += 1
+        if error is not None:
+            self.errors += 1
+            self.last_error = (time.time(), error)
+            return
+        self.bytes += nbytes
+        self.total += seconds
+        self.worst = max(self.worst, seconds)
+        self._samples.append(seconds)
+
+    def as_dict(self):
+        samples = sorted(self._samples)
+        ok = self.operations - self.errors
+
+        def percentile(p):
+            return samples[min(len(samples) - 1, int(p * len(samples)))] * 1000 if samples else None
+
+        return {
+            'operations': self.operations,
+            'errors': self.errors,
+            'bytes': self.bytes,
+            'mean_ms': self.total / ok * 1000 if ok else None,
+            'p50_ms': percentile(0.50),
+            'p95_ms': percentile(0.95),
+            'max_ms': self.worst * 1000 if ok else None,
+            'throughput_Bps': self.bytes / self.total if self.total else None,
+            'last_error': self.last_error,
+        }
+
+
+class Transport:
+    """
+    Liaison avec le firmware : lectures et écritures de registres en rafale,
+    attente d'un changement d'état. Les sous-classes implémentent _read et
+    _write ; les lectures/écritures publiques mesurent la latence de chaque
+    opération, globalement dans self.stats et par (page, registre) dans
+    self.register_stats, et lèvent TransportError en cas d'échec.
+    """
+
+    url = None
+
+    def __init__(self):
+        self.stats = LinkStats()
+        self.register_stats = {}
+        self.page = PAGE_STATUS     # Dernière page sélectionnée
+
+    def _timed(self, operation, reg, nbytes, arg):
+        key = (self.page, reg)
+        if key not in self.register_stats:
+            self.register_stats[key] = LinkStats()
+        counters = (self.stats, self.register_stats[key])
+
+        start = time.perf_counter()
+        try:
+            result = operation(reg, arg)
+        except Exception as e:
+            for stats in counters:
+                stats.record(time.perf_counter() - start, error=str(e))
+            if isinstance(e, TransportError):
+                raise
+            raise TransportError(str(e)) from e
+        for stats in counters:
+            stats.record(time.perf_counter() - start, nbytes)
+        return result
+
+    def read_block(self, reg, length):
+        return self._timed(self._read, reg, length, length)
+
+    def write_block(self, reg, data):
+        data = list(data)
+        self._timed(self._write, reg, len(data), data)
+        if reg == REG_PAGE_SELECT:
+            self.page = data[0]
+
+    def read_byte(self, reg):
+        return self.read_block(reg, 1)[0]
+
+    def write_byte(self, reg, value):
+        self.write_block(reg, [value])
+
+    def wait_event(self, timeout):
+        """
+        Attend qu'une donnée change côté firmware (REG_CHANGE_FLAG), sans
+        remettre le flag à zéro
+
+        Returns:
+            True si un changement est signalé avant le timeout, False sinon
+        """
+        deadline = time.monotonic() + timeout
+        while True:
+            if self.read_byte(REG_CHANGE_FLAG):
+                return True
+            if time.monotonic() >= deadline:
+                return False
+            time.sleep(self.EVENT_POLL)
+
+    EVENT_POLL = 0.02
+
+    def bus_hz(self):
+        """Fréquence du bus physique, None si sans objet ou inconnue"""
+        return None
+
+    def close(self):
+        pass
+
+
+class I2CTransport(Transport):
+    """
+    Bus I2C de la Pi (smbus2)
+
+    Les transactions s'enchaînent sans pause : l'esclave étire l'horloge le
+    temps de son ISR (SOFT_I2C_ISR_BUDGET_US au plus, compté dans la page
+    bus sinon), y compris à 400 kHz. `gap` rétablit une pause après chaque
+    transaction pour comparer.
+    """
+
+    def __init__(self, bus_num=I2C_BUS, slave_addr=SLAVE_ADDRESS, gap=0.0):
+        super().__init__()
+        import smbus2   # Seulement nécessaire avec le transport I2C
+        self.bus = smbus2.SMBus(bus_num)
+        self.bus_num = bus_num
+        self.slave_addr = slave_addr
+        self.gap = gap
+        self.url = f'i2c:{bus_num}@{slave_addr:#04x}'
+
+    def bus_hz(self):
+        """Fréquence du bus d'après le device tree (dtparam=i2c_arm_baudrate), None si inconnue"""
+        try:
+            with open(f'/sys/class/i2c-adapter/i2c-{self.bus_num}/of_node/clock-frequency', 'rb') as f:
+                return int.from_bytes(f.read(4), 'big')
+        except OSError:
+            return None
+
+    def _read(self, reg, length):
+        if length == 1:
+            values = [self.bus.read_byte_data(self.slave_addr, reg)]
+        else:
+            values = self.bus.read_i2c_block_data(self.slave_addr, reg, length)
+        if self.gap:
+            time.sleep(self.gap)
+        return values
+
+    def _write(self, reg, data):
+        if len(data) == 1:
+            self.bus.write_byte_data(self.slave_addr, reg, data[0])
+        else:
+            self.bus.write_i2c_block_data(self.slave_addr, reg, data)
+        if self.gap:
+            time.sleep(self.gap)
+
+    def close(self):
+        self.bus.close()
+
+
+class SerialTransport(Transport):
+    """
+    Télémétrie série (firmware make TELEMETRY=1), en réception seule : les
+    lectures de la page 0 sont servies par le dernier instantané des
+    registres (100 ms au plus), les événements réveillent wait_event().
+    Les autres pages et les commandes ne passent que par l'I2C.
+    """
+
+    SNAPSHOT_TIMEOUT = 1.0
+
+    def __init__(self, port=TELEMETRY_PORT, baud=TELEMETRY_BAUD):
+        super().__init__()
+        self.stream = TelemetryStream(port, baud)
+        self.url = f'serial:{port}@{baud}'
+        self.registers = None
+        self.snapshots = 0
+        self.changed = False
+
+    def _handle(self, record):
+        if record['type'] == 'state':
+            self.registers = bytearray(record['registers'])
+            self.snapshots += 1
+        elif record['type'] in EVENT_TYPES.values():
+            self.changed = True
+
+    def _pump(self, block_until=None):
+        """Traite les trames déjà reçues, et attend jusqu'à block_until (monotonic) si donné"""
+        while self.stream.serial.in_waiting or self.stream.pending():
+            self._handle_next(0)
+        while block_until is not None and time.monotonic() < block_until:
+            if self._handle_next(block_until - time.monotonic()):
+                return
+
+    def _handle_next(self, timeout):
+        self.stream.serial.timeout = max(timeout, 0)
+        record = self.stream.read()
+        if record is not None:
+            self._handle(record)
+        return record is not None
+
+    def _read(self, reg, length):
+        if self.page != PAGE_STATUS:
+            raise TransportError(f"page {self.page} indisponible sur la liaison série")
+        self._pump()
+        deadline = time.monotonic() + self.SNAPSHOT_TIMEOUT
+        while self.registers is None and time.monotonic() < deadline:
+            self._pump(deadline)
+        if self.registers is None or reg + length > len(self.registers):
+            raise TransportError("aucun instantané des registres (firmware compilé sans TELEMETRY=1 ?)")
+        if reg == REG_STATUS_FRAME:
+            return list(status_frame(self.registers, self.snapshots)[:length])
+
+        values = list(self.registers[reg:reg + length])
+        if reg <= REG_CHANGE_FLAG < reg + length:
+            values[REG_CHANGE_FLAG - reg] = int(self.changed)
+        return values
+
+    def _write(self, reg, data):
+        # Seuls les registres gérés côté Pi sont acceptés
+        if reg == REG_CHANGE_FLAG and data == [0]:
+            self.changed = False
+        elif reg == REG_PAGE_SELECT and len(data) == 1:
+            pass    # Prise en compte par Transport.write_block
+        else:
+            raise TransportError("liaison série en émission seule : commande impossible")
+
+    def wait_event(self, timeout):
+        deadline = time.monotonic() + timeout
+        self._pump()
+        while not self.changed and time.monotonic() < deadline:
+            self._pump(deadline)
+        return self.changed
+
+    def close(self):
+        self.stream.close()
+
+
+class SimulatedParking:
+    """
+    Modèle du firmware en mémoire, pour faire tourner le CLI et l'interface
+    web sans carte : une voiture arrive toutes les CAR_PERIOD secondes et
+    reste CAR_STAY secondes, la nuit tombe toutes les DAY_PERIOD secondes.
+    Servo manuel, fenêtre paramètres, FIFO d'événements et pages config,
+    stats et place 0 suivent le protocole du firmware ; le journal EEPROM
+    est vide et les autres pages sont à zéro.
+    """
+
+    CAR_PERIOD = 20.0
+    CAR_STAY = 6.0
+    DAY_PERIOD = 300.0
+    REGISTER_COUNT = REG_FREE_SPOTS + 1
+
+    # Valeurs par défaut de drivers/params.c
+    DEFAULTS = {'barrier_hold_ms': 5000, 'open_angle': 120, 'ir_period_ms': 80,
+                'light_period_ms': 100, 'led_period_ms': 50, 'i2c_address': 0x32,
+                'hold_policy': 0, 'rush_gap_ms': 20000, 'rush_hold_ms': 10000,
+                'short_hold_ms': 2500, 'beam_spacing_mm': 300, 'preopen_angle': 0,
+                'preopen_timeout_ms': 8000, 'servo_ms_per_deg': 3}
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.start = time.monotonic()
+        self.regs = bytearray(self.REGISTER_COUNT)
+        self.page = PAGE_STATUS
+        self.params = {PARAMS[name][0]: value for name, value in self.DEFAULTS.items()}
+        self.staged = dict(self.params)
+        self.manual_angle = None
+        self.events = collections.deque(maxlen=16)    # Comme la FIFO du firmware
+        self.event_seq = 0                              # Numéro de self.events[0]
+        self.last_change = 0
+        self.latched = bytes(8)
+        self.arrivals = 0
+        self.spot_change = 0
+        self.bus = dict.fromkeys(BUS_COUNTERS, 0)
+
+        self.regs[REG_SYSTEM_STATUS] = SYS_STATUS_OK
+        self.regs[REG_RESET_CAUSE] = 0x01
+        self.regs[REG_SPOT_COUNT] = 1
+        self._update()
+
+    def uptime_ms(self):
+        return int((time.monotonic() - self.start) * 1000)
+
+    def _set(self, reg, value, event=None):
+        if self.regs[reg] == value:
+            return
+        self.regs[reg] = value
+        if event is not None:
+            self.last_change = self.uptime_ms()
+            if len(self.events) == self.events.maxlen:
+                self.event_seq = (self.event_seq + 1) & 0xFF
+            self.events.append((self.last_change, event, value))
+            self.regs[REG_CHANGE_FLAG] = 1
+
+    def _update(self):
+        now = time.monotonic() - self.start
+        in_cycle = now % self.CAR_PERIOD
+        car = in_cycle < self.CAR_STAY
+        dark = (now % self.DAY_PERIOD) >= self.DAY_PERIOD / 2
+
+        hold = self.params[PARAMS['barrier_hold_ms'][0]] / 1000
+        released = 0 if car else min(int((in_cycle - self.CAR_STAY) / 0.05), 255)
+        if self.manual_angle is not None:
+            angle = self.manual_angle
+        else:
+            angle = self.params[PARAMS['open_angle'][0]] if car or in_cycle < self.CAR_STAY + hold else 0
+
+        if self.regs[REG_CAR_STATE] != int(car):
+            self.arrivals += car
+            self.spot_change = self.uptime_ms()
+        self._set(REG_CAR_STATE, int(car), event=1)
+        self._set(REG_LIGHT_STATE, int(dark), event=2)
+        self._set(REG_SERVO_ANGLE, angle, event=3)
+        self._set(REG_LED_STATE, (0x01 if car else 0x02) | (0x04 if dark else 0), event=4)
+        self._set(REG_RELEASE_COUNTER, released)
+        self._set(REG_OCCUPANCY_L, int(car))
+        self._set(REG_FREE_SPOTS, 0 if car or in_cycle < self.CAR_STAY + hold else 1)
+        self.regs[REG_HEARTBEAT] = int(now / HEARTBEAT_PERIOD) & 0xFF
+        self.regs[REG_CPU_LOAD_1S] = self.regs[REG_CPU_LOAD_60S] = 12
+        self.regs[REG_HOLD_POLICY] = self.params[PARAMS['hold_policy'][0]]
+
+    def _param_command(self, cmd, param_id, value):
+        if cmd == PARAM_CMD_READ and param_id in self.params:
+            value = self.params[param_id]
+        elif cmd == PARAM_CMD_WRITE and any(pid == param_id and low <= value <= high
+                                            for pid, low, high in PARAMS.values()):
+            self.staged[param_id] = value
+        elif cmd == PARAM_CMD_COMMIT:
+            self.params = dict(self.staged)
+        elif cmd == PARAM_CMD_DEFAULTS:
+            self.staged = {PARAMS[name][0]: v for name, v in self.DEFAULTS.items()}
+        else:
+            self.regs[REG_PARAM_CTRL] = PARAM_CMD_ERROR
+            return
+        self.regs[REG_PARAM_ID] = param_id
+        self.regs[REG_PARAM_ID + 1] = value & 0xFF
+        self.regs[REG_PARAM_ID + 2] = value >> 8
+        self.regs[REG_PARAM_CTRL] = 0
+
+    def _event_batch(self):
+        # Les enregistrements restent dans la FIFO jusqu'à l'acquittement
+        batch = bytearray(EVENT_BATCH_SIZE)
+        count = min(len(self.events), (EVENT_BATCH_SIZE - EVENT_BATCH_HEADER) // EVENT_RECORD_SIZE)
+        for i in range(count):
+            timestamp, event, value = self.events[i]
+            offset = EVENT_BATCH_HEADER + i * EVENT_RECORD_SIZE
+            batch[offset:offset + EVENT_RECORD_SIZE] = timestamp.to_bytes(4, 'little') + bytes([event, value])
+        batch[0] = count | (0x80 if len(self.events) > count else 0)
+        batch[2] = self.event_seq
+        return batch
+
+    def _event_ack(self, ack):
+        done = (ack - self.event_seq) & 0xFF
+        if done <= len(self.events):
+            for _ in range(done):
+                self.events.popleft()
+            self.event_seq = ack
+
+    def _page(self, page):
+        data = bytearray(64)
+        if page == PAGE_CONFIG:
+            for pid, value in self.params.items():
+                data[2 * pid:2 * pid + 2] = value.to_bytes(2, 'little')
+        elif page == PAGE_STATS:
+            data[0:4] = bytes([self.regs[REG_CPU_LOAD_1S], self.regs[REG_CPU_LOAD_60S]]) + (1040).to_bytes(2, 'little')
+        elif page == PAGE_BUS:
+            for i, name in enumerate(BUS_COUNTERS):
+                data[2 * i:2 * i + 2] = (self.bus[name] & 0xFFFF).to_bytes(2, 'little')
+        elif page == PAGE_SPOT_0:
+            data[0:3] = bytes([self.regs[REG_CAR_STATE], self.regs[REG_FREE_SPOTS], self.regs[REG_RELEASE_COUNTER]])
+            data[4:10] = self.arrivals.to_bytes(2, 'little') + self.spot_change.to_bytes(4, 'little')
+        return data
+
+    def read(self, reg, length):
+        with self.lock:
+            self.bus['reads'] += 1
+            self.bus['bytes_out'] += length
+            self._update()
+            if self.page != PAGE_STATUS:
+                return list(self._page(self.page)[reg:reg + length])
+            if reg == REG_EVENT_FIFO:
+                return list(self._event_batch()[:length])
+            if reg == REG_JOURNAL_STREAM:
+                return [0] * length
+            if reg == REG_STATUS_FRAME:
+                # Même instantané que le firmware : refait à chaque cycle du servo (50 ms)
+                regs = bytearray(self.regs)
+                regs[REG_UPTIME_0:REG_UPTIME_0 + 8] = (self.uptime_ms().to_bytes(4, 'little')
+                                                       + self.last_change.to_bytes(4, 'little'))
+                address = self.params[PARAMS['i2c_address'][0]]
+                return list(status_frame(regs, self.uptime_ms() // 50, address)[:length])
+
+            if reg == REG_UPTIME_0:
+                # Même verrouillage que le firmware : uptime et dernier changement cohérents
+                self.latched = self.uptime_ms().to_bytes(4, 'little') + self.last_change.to_bytes(4, 'little')
+            regs = bytearray(self.regs)
+            regs[REG_UPTIME_0:REG_UPTIME_0 + 8] = self.latched
+            if reg + length > len(regs):
+                raise TransportError(f"registre {reg + length - 1} inexistant")
+            return list(regs[reg:reg + length])
+
+    def write(self, reg, data):
+        with self.lock:
+            self.bus['writes'] += 1
+            self.bus['bytes_in'] += 1 + len(data)
+            if reg == REG_PAGE_SELECT:
+                self.page = data[0]
+            elif reg == REG_SERVO_COMMAND:
+                if data[0] == 255:
+                    self.manual_angle = None
+                elif 0 < data[0] <= 180:
+                    self.manual_angle = data[0]
+            elif reg == REG_PARAM_ID and len(data) == 4:
+                self._param_command(data[3], data[0], data[1] | (data[2] << 8))
+            elif reg == REG_JOURNAL_CTRL:
+                pass    # Rembobinage immédiat d'un journal vide
+            elif reg == REG_EVENT_FIFO and self.page == PAGE_STATUS:
+                self._event_ack(data[0])
+            elif self.page == PAGE_STATUS and reg + len(data) <= len(self.regs):
+                self.regs[reg:reg + len(data)] = bytes(data)
+            self._update()
+
+
+class SimTransport(Transport):
+    """Firmware simulé dans le processus (SimulatedParking), sans matériel"""
+
+    EVENT_POLL = 0.005
+
+    def __init__(self, model=None):
+        super().__init__()
+        self.model = model or SimulatedParking()
+        self.url = 'sim:'
+
+    def _read(self, reg, length):
+        return self.model.read(reg, length)
+
+    def _write(self, reg, data):
+        self.model.write(reg, data)
+
+
+def open_link(url):
+    """
+    Ouvre un transport à partir de son URL :
+      i2c:BUS@ADDR          ex. i2c:1@0x32 (i2c: seul = bus et adresse par défaut)
+      serial:PORT[@BAUD]    ex. serial:/dev/ttyACM0@1000000
+      sim:                  firmware simulé
+    """
+    scheme, sep, rest = url.partition(':')
+    if not sep:
+        raise ValueError(f"URL de liaison invalide : {url}")
+    if scheme == 'i2c':
+        bus, _, addr = rest.partition('@')
+        return I2CTransport(int(bus) if bus else I2C_BUS, int(addr, 0) if addr else SLAVE_ADDRESS)
+    if scheme == 'serial':
+        port, _, baud = rest.rpartition('@') if '@' in rest else (rest, '', '')
+        return SerialTransport(port or TELEMETRY_PORT, int(baud) if baud else TELEMETRY_BAUD)
+    if scheme == 'sim':
+        return SimTransport()
+    raise ValueError(f"transport inconnu : {scheme} (i2c, serial ou sim)")
 
 
 class ParkingMaster:
     """Classe pour gérer la communication I2C avec le système de parking Arduino"""
     
-    def __init__(self, bus_num=I2C_BUS, slave_addr=SLAVE_ADDRESS):
+    def __init__(self, bus_num=I2C_BUS, slave_addr=SLAVE_ADDRESS, link=None):
+        """
+        Ouvre la liaison avec le firmware
+
+        Args:
+            bus_num: Numéro du bus I2C
+            slave_addr: Adresse I2C de l'Arduino slave
+            link: Transport ou URL de transport (voir open_link), bus I2C
+                  bus_num/slave_addr si None
+        """
+        if link is None:
+            link = I2CTransport(bus_num, slave_addr)
+        elif isinstance(link, str):
+            link = open_link(link)
+        self.link = link
+
+        # Suivi du heartbeat entre deux appels à check_heartbeat()
+        self._last_heartbeat = None
+        self._last_heartbeat_time = None
+        self._stale_polls = 0
+
+        # Référence (horloge locale, uptime firmware) pour l'estimation de dérive
+        self._clock_ref = None
+
+        # Compteur d'événements perdus côté firmware (modulo 256)
+        self._events_lost_raw = None
+        self.events_lost = 0
+
+        # Numéro du prochain événement attendu (acquittement de la FIFO)
+        self._event_seq = None
+
+        # Génération et compteurs de la dernière rafale d'occupation remise
+        # à zéro, au cas où l'écriture de la remise à zéro se serait perdue
+        self._occupancy_reset = None
+
+        # Enregistrements du journal EEPROM rejetés (CRC invalide)
+        self.journal_corrupted = 0
+
+        # Dernière lecture des compteurs I2C du firmware (get_bus_stats)
+        self._bus_prev = None
+
+        # Trames de status rejetées (PEC invalide ou lecture en erreur) et relues
+        self.frame_errors = 0
+        
+    def read_register(self, reg):
+        """
+        Lit un registre I2C
+        
+        Args:
+            reg: Numéro du registre (0-15)
+            
+        Returns:
+            Valeur du registre ou None en cas d'erreur
+        """
+        try:
+            return self.link.read_byte(reg)
+        except Exception as e:
+            print(f"Erreur lors de la lecture du registre {reg}: {e}")
+            return None
+    
+    def read_block(self, reg, length):
+        """
+        Lit plusieurs registres consécutifs en une seule transaction I2C
+
+        Args:
+            reg: Premier registre
+            length: Nombre d'octets à lire (32 max)
+
+        Returns:
+            Liste des valeurs ou None en cas d'erreur
+        """
+        try:
+            return self.link.read_block(reg, length)
+        except Exception as e:
+            print(f"Erreur lors de la lecture des registres {reg}-{reg + length - 1}: {e}")
+            return None
+
+    def read_page(self, page, reg, length):
+        """
+        Lit une rafale dans une page de registres puis revient à la page 0
+
+        Args:
+            page: Numéro de page (PAGE_*)
+            reg: Premier registre dans la page
+            length: Nombre d'octets à lire (32 max)
+
+        Returns:
+            Liste des valeurs ou None en cas d'erreur
+        """
+        if not self.write_register(REG_PAGE_SELECT, page):
+            return None
+        try:
+            return self.read_block(reg, length)
+        finally:
+            self.write_register(REG_PAGE_SELECT, PAGE_STATUS)
+
+    def write_register(self, reg, value):
+        """
+        Écrit dans un registre I2C
+        
+        Args:
+            reg: Numéro du registre (0-15)
+            value: Valeur à écrire (0-255)
+            
+        Returns:
+            True si succès, False sinon
+        """
+        try:
+            self.link.write_byte(reg, value)
+            return True
+        except Exception as e:
+            print(f"Erreur lors de l'écriture du registre {reg}: {e}")
+            return False
+        
+    def get_car_state(self):
+        """
+        Récupère l'état de détection de voiture
+        
+        Returns:
+            1 si une voiture est détectée, 0 sinon
+        """
+        return self.read_register(REG_CAR_STATE)
+    
+    def get_light_state(self):
+        """
+        Récupère l'état du capteur de lumière
+        
+        Returns:
+            1 si il fait sombre, 0 sinon
+        """
+        return self.read_register(REG_LIGHT_STATE)
+    
+    def get_servo_angle(self):
+        """
+        Récupère l'angle actuel du servo
+        
+        Returns:
+            Angle du servo (0-180 degrés)
+        """
+        return self.read_register(REG_SERVO_ANGLE)
+    
+    def get_led_state(self):
+        """
+        Récupère l'état des LEDs
+        
+        Returns:
+            Byte avec les bits: bit0=RED, bit1=GREEN, bit2=WHITE
+        """
+        return self.read_register(REG_LED_STATE)
+    
+    def get_release_counter(self):
+        """
+        Récupère le compteur de release
+        
+        Returns:
+            Valeur du compteur (0-40)
+        """
+        return self.read_register(REG_RELEASE_COUNTER)
+    
+    def get_system_status(self):
+        """
+        Récupère le status général du système
+
+        Returns:
+            0x01 si système OK, autre valeur sinon
+        """
+        return self.read_register(REG_SYSTEM_STATUS)
+
+    def get_occupancy(self):
+        """
+        Récupère l'occupation de toutes les places en une transaction
+
+        Returns:
+            Dict avec la liste 'occupied' (une entrée par place) et le nombre
+            de places libres, ou None en cas d'erreur
+        """
+        data = self.read_block(REG_OCCUPANCY_L, 4)
+        if data is None:
+            return None
+
+        bitmap = data[0] | (data[1] << 8)
+        return {
+            'occupied': [bool(bitmap & (1 << n)) for n in range(data[2])],
+            'free_spots': data[3]
+        }
+
+    def get_spot(self, spot):
+        """
+        Récupère l'état détaillé d'une place (page PAGE_SPOT_0 + spot)
+
+        Returns:
+            Dict ou None en cas d'erreur
+        """
+        data = self.read_page(PAGE_SPOT_0 + spot, 0, SPOT_PAGE_SIZE)
+        if data is None:
+            return None
+
+        return {
+            'car_detected': bool(data[0]),
+            'released': bool(data[1]),
+            'release_counter': data[2],
+            'arrivals': data[4] | (data[5] << 8),
+            'last_change_ms': int.from_bytes(bytes(data[6:10]), 'little')
+        }
+
+    def set_hold_policy(self, name):
+        """
+        Change la politique de maintien de la barrière (immédiat, non
+        sauvegardé : utiliser --set hold_policy=N pour le démarrage)
+
+        Args:
+            name: Nom de la politique (clé de HOLD_POLICIES)
+        """
+        return self.write_register(REG_HOLD_POLICY, HOLD_POLICIES[name])
+
+    def run_program(self, text):
+        """
+        Charge un programme dans la page program et le lance. Le firmware le
+        vérifie avant de bouger la barrière : voir get_program_status()
+
+        Args:
+            text: Programme texte (voir assemble_program)
+        """
+        code = assemble_program(text)
+        if not self.write_register(REG_PAGE_SELECT, PAGE_PROGRAM):
+            return False
+        try:
+            self.link.write_block(PROG_CODE_OFFSET, code)
+            return self.write_register(0, PROG_CMD_RUN)
+        except Exception as e:
+            print(f"Erreur lors de l'envoi du programme : {e}")
+            return False
+        finally:
+            self.write_register(REG_PAGE_SELECT, PAGE_STATUS)
+
+    def stop_program(self):
+        """Arrête le programme en cours et revient au mode automatique"""
+        if not self.write_register(REG_PAGE_SELECT, PAGE_PROGRAM):
+            return False
+        try:
+            return self.write_register(0, PROG_CMD_STOP)
+        finally:
+            self.write_register(REG_PAGE_SELECT, PAGE_STATUS)
+
+    def get_program_status(self):
+        """
+        Returns:
+            Dict avec l'état du programme, l'adresse de l'instruction courante
+            (ou fautive) et les tours de boucle restants ; None en cas d'erreur
+        """
+        data = self.read_page(PAGE_PROGRAM, 0, 4)
+        if data is None:
+            return None
+        return {
+            'pending': data[0] != 0,
+            'status': PROG_STATUS.get(data[1], data[1]),
+            'pc': data[2],
+            'loops_left': data[3]
+        }
+
+    def get_policy_stats(self):
+        """
+        Récupère les compteurs par politique de maintien (page policy)
+
+        Returns:
+            Dict avec, par politique, les voitures servies, les cycles de la
+            barrière et le débit horaire, plus la politique active ; None en
+            cas d'erreur
+        """
+        policy = self.read_register(REG_HOLD_POLICY)
+        data = self.read_page(PAGE_POLICY, 0, 16)
+        if policy is None or data is None:
+            return None
+
+        words = [data[i] | (data[i + 1] << 8) for i in range(0, 16, 2)]
+        count = len(HOLD_POLICIES)
+        stats = {
+            'active': next((n for n, v in HOLD_POLICIES.items() if v == policy), policy),
+            'avg_gap_s': None if words[3 * count] == 0xFFFF else words[3 * count],
+            'hold_ms': words[3 * count + 1]
+        }
+        for name, i in HOLD_POLICIES.items():
+            cars, cycles, minutes = words[i], words[count + i], words[2 * count + i]
+            stats[name] = {
+                'cars_served': cars,
+                'barrier_cycles': cycles,
+                'active_min': minutes,
+                'cars_per_hour': cars * 60 / minutes if minutes else None,
+                'cycles_per_car': cycles / cars if cars else None
+            }
+        return stats
+
+    def get_traffic(self):
+        """
+        Récupère le comptage entrées/sorties du firmware (page traffic)
+
+        Returns:
+            Dict avec les places occupées, les entrées, sorties, demi-tours,
+            la vitesse (km/h) et le sens du dernier passage ; None en cas d'erreur
+        """
+        data = self.read_page(PAGE_TRAFFIC, 0, 12)
+        if data is None:
+            return None
+
+        words = [data[i] | (data[i + 1] << 8) for i in range(0, 10, 2)]
+        return {
+            'occupied': words[0],
+            'entries': words[1],
+            'exits': words[2],
+            'aborted': words[3],
+            'last_speed_kmh': words[4] * 0.036,
+            'last_direction': TRAFFIC_DIRECTIONS.get(data[10]),
+            'edges_lost': data[11]
+        }
+
+    def get_approach_stats(self):
+        """
+        Récupère les mesures de la pré-ouverture (page approach)
+
+        Returns:
+            Dict avec les compteurs, les temps d'attente et de dégagement de la
+            dernière voiture et leurs moyennes glissantes (ms), l'attente étant
+            séparée selon que la barrière était pré-ouverte ou non ; None en
+            cas d'erreur
+        """
+        data = self.read_page(PAGE_APPROACH, 0, 16)
+        if data is None:
+            return None
+
+        words = [data[i] | (data[i + 1] << 8) for i in range(0, 16, 2)]
+        return {
+            'cars': words[0],
+            'preopened_cars': words[1],
+            'preopen_timeouts': words[2],
+            'last_wait_ms': words[3],
+            'last_clear_ms': words[4],
+            'avg_wait_ms': words[5],
+            'avg_wait_preopened_ms': words[6],
+            'avg_clear_ms': words[7]
+        }
+
+    def _read_occupancy_burst(self):
+        """Lit la page 8 ; (séquence de la rafale, statistiques) ou
+        (None, None) si la lecture échoue ou si la somme de contrôle est
+        fausse (rafale corrompue)"""
+        data = self.read_page(PAGE_OCCUPANCY, 0, 32)
+        if data is None or len(data) < 32 or sum(data) & 0xFF:
+            return None, None
+
+        hist = [data[8 + 2 * i] | (data[9 + 2 * i] << 8) for i in range(OCCUPANCY_BINS)]
+        return data[2], {
+            'entries': data[0] | (data[1] << 8),
+            'departures': sum(hist),
+            'longest_dwell_s': data[4] | (data[5] << 8),
+            'utilisation_pct': data[6],
+            'generation': data[7],
+            'dwell_hist': hist
+        }
+
+    def get_occupancy_stats(self, reset=False):
+        """
+        Récupère les statistiques d'occupation calculées par le firmware
+
+        Args:
+            reset: Remet à zéro les compteurs (arrivées, départs, histogramme)
+                   une fois la rafale vérifiée (deux lectures identiques) :
+                   une lecture par minute suffit alors pour suivre toutes les
+                   arrivées. Le firmware ne retranche que la rafale nommée
+                   par sa séquence, et seulement si aucun autre lecteur n'a
+                   relu la page entre-temps. Si la remise à zéro précédente
+                   n'a pas eu lieu (même génération), seuls les écarts sont
+                   rendus.
+
+        Returns:
+            Dict avec les arrivées, départs, le plus long stationnement en
+            cours (s), le taux d'occupation sur une heure (%), la génération,
+            les places occupées et l'histogramme des durées ; None en cas
+            d'erreur
+        """
+        previous = None
+        for _ in range(OCCUPANCY_RETRIES):
+            sequence, stats = self._read_occupancy_burst()
+            if stats is not None and (not reset or stats == previous):
+                break
+            previous = stats
+        else:
+            print("❌ Statistiques d'occupation illisibles")
+            return None
+
+        occupancy = self.get_occupancy()
+        if occupancy is None:
+            return None
+        stats['occupied'] = sum(occupancy['occupied'])
+
+        if reset:
+            counters = [stats['entries']] + stats['dwell_hist']
+            done = self._occupancy_reset
+            if done is not None and done[0] == stats['generation'] \
+                    and all(c >= d for c, d in zip(counters, done[1])):
+                delta = [c - d for c, d in zip(counters, done[1])]
+                stats['entries'], stats['dwell_hist'] = delta[0], delta[1:]
+                stats['departures'] = sum(stats['dwell_hist'])
+            self._occupancy_reset = (stats['generation'], counters)
+
+            # Sans cette écriture (ou si un autre lecteur a relu la page),
+            # la lecture suivante rend les mêmes compteurs sous la même
+            # génération : ils sont déjà déduits
+            if self.write_register(REG_PAGE_SELECT, PAGE_OCCUPANCY_RESET):
+                try:
+                    self.link.write_block(0, [sequence, stats['generation']])
+                except Exception as e:
+                    print(f"Erreur lors de la remise à zéro de l'occupation : {e}")
+                finally:
+                    self.write_register(REG_PAGE_SELECT, PAGE_STATUS)
+        return stats
+
+    def get_bus_stats(self):
+        """
+        Compteurs I2C côté esclave (page bus) et écarts depuis l'appel précédent
+
+        Les compteurs du firmware rebouclent à 65536 : les écarts (clé
+        'delta') sont calculés modulo 2^16, à rapprocher des erreurs du
+        transport (link_stats, register_stats) sur le même intervalle.
+
+        Returns:
+            Dict des compteurs (BUS_COUNTERS) avec 'delta', ou None en cas d'erreur
+        """
+        data = self.read_page(PAGE_BUS, 0, 2 * len(BUS_COUNTERS))
+        if data is None:
+            return None
+
+        counters = {name: data[2 * i] | (data[2 * i + 1] << 8) for i, name in enumerate(BUS_COUNTERS)}
+        prev = self._bus_prev
+        counters['delta'] = {name: (counters[name] - prev[name]) & 0xFFFF
+                             for name in BUS_COUNTERS if name != 'isr_max_us'} if prev else None
+        self._bus_prev = {name: counters[name] for name in BUS_COUNTERS}
+        return counters
+
+    def probe_speed(self, transactions=200, rounds=5):
+        """
+        Mesure le nombre de transactions par seconde soutenu sur la liaison,
+        pour chaque charge de SPEED_WORKLOADS
+
+        Résultat reproductible : nombre fixe de transactions enchaînées sans
+        pause, un tour de chauffe ignoré puis `rounds` tours dont on garde la
+        médiane (et l'écart min-max). A relancer après avoir changé la
+        fréquence du bus de la Pi pour comparer 100 et 400 kHz.
+
+        Returns:
+            Dict avec url, bus_hz, workloads (par charge : tps, tps_min,
+            tps_max, bytes_per_s, errors, bus_load) et slave (écarts des
+            compteurs du firmware pendant la mesure, voir get_bus_stats)
+        """
+        bus_hz = self.link.bus_hz()
+        self.get_bus_stats()    # Référence des écarts
+
+        workloads = {}
+        for name, reg, length in SPEED_WORKLOADS:
+            rates = []
+            errors = 0
+            for round_index in range(rounds + 1):
+                ok = 0
+                start = time.perf_counter()
+                for _ in range(transactions):
+                    try:
+                        if length:
+                            self.link.read_block(reg, length)
+                        else:
+                            self.link.write_block(reg, [PAGE_STATUS])
+                        ok += 1
+                    except TransportError:
+                        errors += 1
+                if round_index:
+                    rates.append(ok / (time.perf_counter() - start))
+
+            rates.sort()
+            tps = rates[len(rates) // 2]
+            # START, adresse, registre, (START répété, adresse, données) ou valeur, STOP
+            bits = 2 + 9 * (3 + length) if length else 2 + 9 * 3
+            workloads[name] = {
+                'tps': tps,
+                'tps_min': rates[0],
+                'tps_max': rates[-1],
+                'bytes_per_s': tps * (length or 1),
+                'errors': errors,
+                'bus_load': tps * bits / bus_hz if bus_hz else None,
+            }
+
+        return {'url': self.link.url, 'bus_hz': bus_hz, 'workloads': workloads,
+                'slave': self.get_bus_stats()}
+
+    def register_stats(self):
+        """
+        Latence et erreurs vues par le transport, par registre
+
+        Returns:
+            Dict 'page/registre' -> dict LinkStats, trié par page puis registre
+        """
+        return {f"{page}/{reg}": stats.as_dict()
+                for (page, reg), stats in sorted(self.link.register_stats.items())}
+
+    def get_system_stats(self):
+        """
+        Récupère les statistiques d'exécution du firmware
+
+        Returns:
+            Dict avec la charge CPU (1 s et 60 s, en %) et le pire écart
+            entre deux ticks FreeRTOS (µs), ou None en cas d'erreur
+        """
+        # Une seule rafale dans la page stats : valeurs cohérentes entre elles
+        data = self.read_page(PAGE_STATS, 0, 4)
+        if data is None:
+            return None
+
+        return {
+            'cpu_load_1s': data[0],
+            'cpu_load_60s': data[1],
+            'tick_gap_max_us': data[2] | (data[3] << 8)
+        }
+
+    def get_timing(self):
+        """
+        Lit l'uptime du firmware et l'horodatage du dernier changement d'état
+
+        Les 8 octets sont figés côté firmware au début de la lecture, les deux
+        valeurs sont donc cohérentes entre elles.
+
+        Returns:
+            Dict avec uptime_ms, last_change_ms, change_age_ms (délai entre le
+            changement et cette lecture) et clock_skew_ppm (dérive de l'horloge
+            du firmware par rapport à celle de la Pi), ou None en cas d'erreur
+        """
+        data = self.read_block(REG_UPTIME_0, 8)
+        if data is None:
+            return None
+
+        host_now = time.monotonic()
+        uptime = int.from_bytes(bytes(data[0:4]), 'little')
+        last_change = int.from_bytes(bytes(data[4:8]), 'little')
+
+        # Nouvelle référence au premier appel ou après un reboot du firmware
+        if self._clock_ref is None or uptime < self._clock_ref[1]:
+            self._clock_ref = (host_now, uptime)
+
+        host_elapsed_ms = (host_now - self._clock_ref[0]) * 1000
+        skew_ppm = None
+        if host_elapsed_ms >= 10000:
+            device_elapsed_ms = uptime - self._clock_ref[1]
+            skew_ppm = (device_elapsed_ms - host_elapsed_ms) / host_elapsed_ms * 1e6
+
+        return {
+            'uptime_ms': uptime,
+            'last_change_ms': last_change,
+            'change_age_ms': uptime - last_change,
+            'clock_skew_ppm': skew_ppm
+        }
+
+    def read_events(self):
         """
-        Initialise le bus I2C
-        
-        Args:
-            bus_num: Numéro du bus I2C
-            slave_addr: Adresse I2C de l'Arduino slave
+        Vide la FIFO d'événements du firmware
+
+        Chaque lecture en rafale ramène un lot de 4 enregistrements au plus ;
+        on relit tant que le firmware indique qu'il en reste. Le firmware ne
+        retire un lot de sa FIFO qu'une fois acquitté (numéro du prochain
+        enregistrement attendu écrit dans REG_EVENT_FIFO) : un lot en erreur
+        est relu, jusqu'à EVENT_RETRIES fois, et les enregistrements déjà
+        reçus (acquittement perdu) sont écartés d'après leur numéro. Les
+        événements perdus (FIFO pleine) sont cumulés dans self.events_lost.
+
+        Yields:
+            Dict avec timestamp_ms, type et value pour chaque transition
         """
-        self.bus = smbus2.SMBus(bus_num)
-        self.slave_addr = slave_addr
-        
-    def read_register(self, reg):
+        while True:
+            for _ in range(EVENT_RETRIES + 1):
+                data = self.read_block(REG_EVENT_FIFO, EVENT_BATCH_SIZE)
+                if (data is not None and len(data) >= EVENT_BATCH_HEADER and
+                        len(data) >= EVENT_BATCH_HEADER + (data[0] & 0x7F) * EVENT_RECORD_SIZE):
+                    break
+            else:
+                return
+
+            count = data[0] & 0x7F
+            more = bool(data[0] & 0x80)
+            seq = data[2]
+
+            lost_raw = data[1]
+            if self._events_lost_raw is not None:
+                self.events_lost += (lost_raw - self._events_lost_raw) & 0xFF
+            self._events_lost_raw = lost_raw
+
+            # Début du lot déjà reçu (acquittement précédent non parvenu)
+            skip = 0
+            if self._event_seq is not None:
+                behind = (self._event_seq - seq) & 0xFF
+                if behind < 0x80:
+                    skip = min(behind, count)
+
+            for i in range(skip, count):
+                offset = EVENT_BATCH_HEADER + i * EVENT_RECORD_SIZE
+                record = bytes(data[offset:offset + EVENT_RECORD_SIZE])
+                event_type = record[4]
+                event = {
+                    'timestamp_ms': int.from_bytes(record[0:4], 'little'),
+                    'type': EVENT_TYPES.get(event_type, event_type),
+                    'value': record[5]
+                }
+                if event['type'] == 'car':
+                    # bit 0 = voiture présente, bits 1-7 = numéro de place
+                    event['spot'] = record[5] >> 1
+                    event['value'] = record[5] & 1
+                self._event_seq = (seq + i + 1) & 0xFF
+                yield event
+
+            # Acquittement : le firmware retire le lot à la lecture suivante.
+            # En cas d'échec, le même lot sera renvoyé et écarté ci-dessus.
+            if self._event_seq is None:
+                self._event_seq = seq
+            if count and not self.write_register(REG_EVENT_FIFO, self._event_seq):
+                return
+            if not more:
+                return
+
+    def read_trace(self):
         """
-        Lit un registre I2C
-        
+        Relit l'anneau de trace du noyau (firmware compilé avec make TRACE=1).
+        L'enregistrement est figé pendant la relecture puis reprend à vide.
+
+        Returns:
+            (événements décodés, True si des événements plus anciens ont été
+            écrasés) ou None en cas d'erreur / firmware sans trace
+        """
+        records = []
+        overwritten = False
+        telemetry = False
+        if not self.write_register(REG_PAGE_SELECT, PAGE_TRACE):
+            return None
+        try:
+            while True:
+                data = self.read_block(0, 32)
+                if data is None:
+                    return None
+                count = data[0] & 0x7F
+                if data[0] == 0xFF:
+                    print("❌ Firmware compilé sans trace (make TRACE=1)")
+                    return None
+                overwritten |= bool(data[1] & TRACE_DUMP_OVERWRITTEN)
+                telemetry = bool(data[1] & TRACE_DUMP_TELEMETRY)
+                for i in range(count):
+                    offset = 2 + i * TRACE_RECORD_SIZE
+                    records.append((data[offset], data[offset + 1] | (data[offset + 2] << 8)))
+                if not data[0] & 0x80:
+                    break
+        finally:
+            self.write_register(REG_PAGE_SELECT, PAGE_STATUS)
+
+        return decode_trace(records, telemetry), overwritten
+
+    def read_journal(self, timeout=2.0):
+        """
+        Relit tout le journal EEPROM du firmware, du plus ancien au plus récent
+
+        Le journal survit aux coupures de courant : chaque enregistrement
+        porte le numéro de boot et l'uptime (secondes) du changement d'état.
+        Les enregistrements dont le CRC est invalide sont ignorés et comptés
+        dans self.journal_corrupted.
+
         Args:
-            reg: Numéro du registre (0-15)
-            
+            timeout: Délai maximal pour la relecture complète (secondes)
+
         Returns:
-            Valeur du registre ou None en cas d'erreur
+            Liste de dicts (seq, boot, uptime_s et bits d'état) ou None en cas d'erreur
+        """
+        deadline = time.monotonic() + timeout
+
+        # Le rembobinage est traité par la tâche journal (période 200 ms)
+        if not self.write_register(REG_JOURNAL_CTRL, JOURNAL_CMD_REWIND):
+            return None
+        while self.read_register(REG_JOURNAL_CTRL) != 0:
+            if time.monotonic() > deadline:
+                return None
+            time.sleep(0.05)
+
+        records = []
+        while True:
+            data = self.read_block(REG_JOURNAL_STREAM, JOURNAL_BATCH_SIZE)
+            if data is None:
+                return None
+
+            count = data[0] & 0x7F
+            more = bool(data[0] & 0x80)
+
+            for i in range(count):
+                offset = 1 + i * JOURNAL_RECORD_SIZE
+                raw = bytes(data[offset:offset + JOURNAL_RECORD_SIZE])
+                if crc8(raw[:7]) != raw[7]:
+                    self.journal_corrupted += 1
+                    continue
+
+                record = {
+                    'seq': int.from_bytes(raw[0:2], 'little'),
+                    'boot': raw[2],
+                    'uptime_s': int.from_bytes(raw[3:6], 'little')
+                }
+                for name, bit in JOURNAL_STATE_BITS.items():
+                    record[name] = bool(raw[6] & bit)
+                records.append(record)
+
+            if not more:
+                return records
+            if count == 0:
+                # EEPROM en cours d'écriture côté firmware
+                if time.monotonic() > deadline:
+                    return None
+                time.sleep(0.005)
+
+    def _param_command(self, cmd, param_id=0, value=0, timeout=1.0):
+        """
+        Exécute une commande de la fenêtre paramètres (traitée par la tâche
+        journal du firmware, période 200 ms)
+
+        Returns:
+            Valeur de la fenêtre après la commande, ou None si refusée / erreur
         """
         try:
-            value = self.bus.read_byte_data(self.slave_addr, reg)
-            time.sleep(0.001)  # Délai de 1ms entre les lectures
-            return value
+            # Identifiant, valeur et commande en une seule écriture
+            self.link.write_block(REG_PARAM_ID, [param_id, value & 0xFF, value >> 8, cmd])
         except Exception as e:
-            print(f"Erreur lors de la lecture du registre {reg}: {e}")
+            print(f"Erreur lors de l'envoi de la commande paramètre {cmd}: {e}")
             return None
-    
-    def write_register(self, reg, value):
+
+        deadline = time.monotonic() + timeout
+        while True:
+            time.sleep(0.05)
+            data = self.read_block(REG_PARAM_ID, 4)
+            if data is None:
+                return None
+            if data[3] == 0:
+                return data[1] | (data[2] << 8)
+            if data[3] == PARAM_CMD_ERROR or time.monotonic() > deadline:
+                return None
+
+    def get_param(self, name):
         """
-        Écrit dans un registre I2C
-        
+        Lit la valeur en vigueur d'un paramètre
+
         Args:
-            reg: Numéro du registre (0-15)
-            value: Valeur à écrire (0-255)
-            
+            name: Nom du paramètre (clé de PARAMS)
+
         Returns:
-            True si succès, False sinon
+            Valeur ou None en cas d'erreur
         """
-        try:
-            self.bus.write_byte_data(self.slave_addr, reg, value)
-            time.sleep(0.001)  # Délai de 1ms après écriture
-            return True
-        except Exception as e:
-            print(f"Erreur lors de l'écriture du registre {reg}: {e}")
-            return False
-        
-    def get_car_state(self):
+        return self._param_command(PARAM_CMD_READ, PARAMS[name][0])
+
+    def get_all_params(self):
         """
-        Récupère l'état de détection de voiture
-        
+        Lit tous les paramètres en vigueur en une rafale (page config)
+
         Returns:
-            1 si une voiture est détectée, 0 sinon
+            dict nom -> valeur ou None en cas d'erreur
         """
-        return self.read_register(REG_CAR_STATE)
-    
-    def get_light_state(self):
+        data = self.read_page(PAGE_CONFIG, 0, 2 * len(PARAMS))
+        if data is None:
+            return None
+        return {name: data[2 * pid] | (data[2 * pid + 1] << 8) for name, (pid, _, _) in PARAMS.items()}
+
+    def set_params(self, values):
         """
-        Récupère l'état du capteur de lumière
-        
+        Modifie un ou plusieurs paramètres puis les applique ensemble
+
+        Le firmware les applique sans redémarrer (sauf i2c_address) et les
+        sauvegarde en EEPROM.
+
+        Args:
+            values: dict nom -> valeur
+
         Returns:
-            1 si il fait sombre, 0 sinon
+            True si succès, False sinon
         """
-        return self.read_register(REG_LIGHT_STATE)
-    
-    def get_servo_angle(self):
+        for name, value in values.items():
+            param_id, low, high = PARAMS[name]
+            if not low <= value <= high:
+                print(f"Valeur invalide pour {name}: doit être entre {low} et {high}")
+                return False
+            if self._param_command(PARAM_CMD_WRITE, param_id, value) is None:
+                return False
+
+        return self._param_command(PARAM_CMD_COMMIT, timeout=2.0) is not None
+
+    def reset_params(self):
+        """Restaure et applique les valeurs par défaut de tous les paramètres"""
+        if self._param_command(PARAM_CMD_DEFAULTS) is None:
+            return False
+        return self._param_command(PARAM_CMD_COMMIT, timeout=2.0) is not None
+
+    def check_heartbeat(self):
         """
-        Récupère l'angle actuel du servo
-        
+        Vérifie que le heartbeat du firmware progresse entre deux lectures
+
+        Le heartbeat n'avance que si toutes les tâches FreeRTOS tournent.
+        Il est signalé bloqué après HEARTBEAT_STALL_POLLS lectures sans
+        progression, à condition qu'au moins deux périodes se soient écoulées
+        (pour ne pas alerter si on lit plus vite que le firmware).
+
         Returns:
-            Angle du servo (0-180 degrés)
+            Dict avec heartbeat, stalled et le status système, ou None en cas d'erreur
         """
-        return self.read_register(REG_SERVO_ANGLE)
-    
-    def get_led_state(self):
+        heartbeat = self.read_register(REG_HEARTBEAT)
+        status = self.read_register(REG_SYSTEM_STATUS)
+        if heartbeat is None or status is None:
+            return None
+
+        now = time.monotonic()
+        if status == SYS_STATUS_BOOTING:
+            # Le heartbeat ne démarre qu'à la fin du boot
+            self._last_heartbeat = None
+            self._stale_polls = 0
+            return {'heartbeat': heartbeat, 'stalled': False,
+                    'booting': True, 'system_status': status}
+
+        if heartbeat != self._last_heartbeat:
+            self._last_heartbeat = heartbeat
+            self._last_heartbeat_time = now
+            self._stale_polls = 0
+        else:
+            self._stale_polls += 1
+
+        stalled = (self._stale_polls >= HEARTBEAT_STALL_POLLS and
+                   now - self._last_heartbeat_time > 2 * HEARTBEAT_PERIOD)
+
+        return {
+            'heartbeat': heartbeat,
+            'stalled': stalled or status == SYS_STATUS_STALLED,
+            'booting': False,
+            'system_status': status
+        }
+
+    def is_booting(self):
         """
-        Récupère l'état des LEDs
-        
+        Indique si le firmware est encore en phase de démarrage
+
         Returns:
-            Byte avec les bits: bit0=RED, bit1=GREEN, bit2=WHITE
+            True si le status vaut SYS_STATUS_BOOTING, False sinon
         """
-        return self.read_register(REG_LED_STATE)
-    
-    def get_release_counter(self):
+        return self.read_register(REG_SYSTEM_STATUS) == SYS_STATUS_BOOTING
+
+    def wait_until_ready(self, timeout=5.0, poll=0.05):
         """
-        Récupère le compteur de release
-        
+        Attend que le firmware réponde et ait fini de démarrer
+
+        Args:
+            timeout: Délai maximal d'attente (secondes)
+            poll: Intervalle entre deux lectures (secondes)
+
         Returns:
-            Valeur du compteur (0-40)
+            True si le status est OK avant le timeout, False sinon
         """
-        return self.read_register(REG_RELEASE_COUNTER)
-    
-    def get_system_status(self):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            try:
+                # Lecture directe : pendant le reset, les NACK sont attendus
+                status = self.link.read_byte(REG_SYSTEM_STATUS)
+                if status == SYS_STATUS_OK:
+                    return True
+            except OSError:
+                pass
+            time.sleep(poll)
+        return False
+
+    def get_reset_info(self):
         """
-        Récupère le status général du système
+        Récupère la cause du dernier reset et le nombre de redémarrages
 
         Returns:
-            0x01 si système OK, autre valeur sinon
+            Dict avec reset_cause (liste), reset_flags et reboot_count, ou None
         """
-        return self.read_register(REG_SYSTEM_STATUS)
+        flags = self.read_register(REG_RESET_CAUSE)
+        reboots = self.read_register(REG_REBOOT_COUNT)
+        if flags is None or reboots is None:
+            return None
+
+        return {
+            'reset_flags': flags,
+            'reset_cause': [name for bit, name in RESET_CAUSES.items() if flags & bit],
+            'reboot_count': reboots
+        }
+
+    def read_status_frame(self, retries=STATUS_FRAME_RETRIES):
+        """
+        Lit l'instantané du status (REG_STATUS_FRAME) en une rafale et vérifie
+        son PEC. Une trame corrompue ou une lecture en erreur est relue seule,
+        jusqu'à `retries` fois : l'instantané étant préparé par le firmware,
+        la relecture renvoie la même trame ou la suivante, jamais un mélange.
+
+        Returns:
+            Dict avec seq, les registres 0-5, l'occupation, les places libres,
+            uptime_ms et last_change_ms ; None si aucune trame valide
+        """
+        address = getattr(self.link, 'slave_addr', SLAVE_ADDRESS)
+        for _ in range(retries + 1):
+            try:
+                frame = bytes(self.link.read_block(REG_STATUS_FRAME, STATUS_FRAME_SIZE))
+            except Exception as e:
+                print(f"Erreur lors de la lecture de la trame de status : {e}")
+                frame = None
+            if frame is not None and crc8(frame[:-1], status_frame_seed(address)) == frame[-1]:
+                break
+            self.frame_errors += 1
+        else:
+            return None
+
+        return {
+            'seq': frame[0],
+            'registers': frame[1:7],
+            'occupancy': frame[7] | (frame[8] << 8),
+            'free_spots': frame[9],
+            'uptime_ms': int.from_bytes(frame[10:14], 'little'),
+            'last_change_ms': int.from_bytes(frame[14:18], 'little')
+        }
 
     def check_data_changed(self):
         """
@@ -159,27 +1836,25 @@ class ParkingMaster:
             if not force and not self.check_data_changed():
                 return {'changed': False}
 
-            car_state = self.get_car_state()
-            light_state = self.get_light_state()
-            servo_angle = self.get_servo_angle()
-            led_state = self.get_led_state()
-            release_counter = self.get_release_counter()
-
-            if None in [car_state, light_state, servo_angle, led_state, release_counter]:
+            # Une seule rafale, vérifiée par son PEC
+            frame = self.read_status_frame()
+            if frame is None:
                 return None
 
-            # Type narrowing: we know these are not None now
-            assert led_state is not None
-
+            regs = frame['registers']
+            led_state = regs[REG_LED_STATE]
             return {
                 'changed': True,
-                'car_detected': bool(car_state),
-                'is_dark': bool(light_state),
-                'servo_angle': servo_angle,
+                'car_detected': bool(regs[REG_CAR_STATE]),
+                'is_dark': bool(regs[REG_LIGHT_STATE]),
+                'servo_angle': regs[REG_SERVO_ANGLE],
                 'led_red': bool(led_state & 0x01),
                 'led_green': bool(led_state & 0x02),
                 'led_white': bool(led_state & 0x04),
-                'release_counter': release_counter
+                'release_counter': regs[REG_RELEASE_COUNTER],
+                'uptime_ms': frame['uptime_ms'],
+                'last_change_ms': frame['last_change_ms'],
+                'change_age_ms': frame['uptime_ms'] - frame['last_change_ms']
             }
         except Exception as e:
             print(f"Erreur lors de la lecture du status complet: {e}")
@@ -202,9 +1877,27 @@ class ParkingMaster:
         
         return self.write_register(6, angle)
     
+    def wait_for_change(self, timeout):
+        """
+        Attend un changement d'état côté firmware (sans le consommer :
+        get_all_status() remet le flag à zéro)
+
+        Returns:
+            True si une donnée a changé avant le timeout
+        """
+        try:
+            return self.link.wait_event(timeout)
+        except TransportError as e:
+            print(f"Erreur lors de l'attente d'un changement : {e}")
+            return False
+
+    def link_stats(self):
+        """Latence mesurée par le transport depuis l'ouverture (voir LinkStats)"""
+        return dict(self.link.stats.as_dict(), url=self.link.url)
+
     def close(self):
-        """Ferme la connexion I2C"""
-        self.bus.close()
+        """Ferme la liaison"""
+        self.link.close()
 
 
 def display_status(status):
@@ -227,10 +1920,270 @@ def display_status(status):
     print(f"💡 LED Rouge          : {'ON 🔴' if status['led_red'] else 'OFF'}")
     print(f"💡 LED Verte          : {'ON 🟢' if status['led_green'] else 'OFF'}")
     print(f"💡 LED Blanche        : {'ON ⚪' if status['led_white'] else 'OFF'}")
-    print(f"⏱️  Compteur release   : {status['release_counter']}/100")
+    print(f"⏱️  Compteur release   : {status['release_counter']}")
+    print(f"🕒 Uptime firmware     : {status['uptime_ms'] / 1000:.3f} s")
+    print(f"🕒 Dernier changement  : il y a {status['change_age_ms']} ms")
     print("="*50 + "\n")
 
 
+def display_link_stats(stats):
+    """Affiche la latence mesurée par le transport"""
+    def ms(value):
+        return f"{value:.3f} ms" if value is not None else '-'
+
+    print(f"🔗 Liaison {stats['url']} : {stats['operations']} opération(s), {stats['errors']} erreur(s)")
+    print(f"   Latence moyenne {ms(stats['mean_ms'])}, médiane {ms(stats['p50_ms'])}, "
+          f"p95 {ms(stats['p95_ms'])}, pire {ms(stats['max_ms'])}")
+    if stats['throughput_Bps']:
+        print(f"   Débit utile : {stats['throughput_Bps']:.0f} octets/s")
+
+
+def display_bus_stats(master):
+    """Affiche les compteurs I2C du firmware et, en regard, ceux du transport par registre"""
+    bus = master.get_bus_stats()
+    if bus is None:
+        print("❌ Impossible de lire les compteurs I2C du firmware")
+    else:
+        print("📟 Esclave I2C (firmware) :")
+        print(f"   Transactions : {bus['writes']} écriture(s), {bus['reads']} lecture(s)")
+        print(f"   Octets       : {bus['bytes_in']} reçus, {bus['bytes_out']} envoyés")
+        print(f"   Erreurs      : {bus['overruns']} débordement(s), {bus['bus_errors']} erreur(s) de bus, "
+              f"{bus['invalid']} accès invalide(s)")
+        print(f"   ISR TWI la plus longue : {bus['isr_max_us']} µs "
+              f"({bus['slow_isr']} au-delà de {ISR_BUDGET_US} µs)")
+
+    print(f"🔗 Master ({master.link.url}) :")
+    for key, stats in master.register_stats().items():
+        line = f"   {key:>7} : {stats['operations']:5d} op, {stats['errors']:3d} err"
+        if stats['mean_ms'] is not None:
+            line += f", moyenne {stats['mean_ms']:.3f} ms, pire {stats['max_ms']:.3f} ms"
+        if stats['last_error']:
+            when, message = stats['last_error']
+            line += f", dernière erreur {time.strftime('%H:%M:%S', time.localtime(when))} ({message})"
+        print(line)
+    print(f"   Trames de status relues (PEC invalide) : {master.frame_errors}")
+
+
+def display_speed_probe(probe):
+    """Affiche le résultat de ParkingMaster.probe_speed()"""
+    bus_hz = probe['bus_hz']
+    print(f"🚀 Débit soutenu sur {probe['url']}"
+          f" (bus {bus_hz / 1000:.0f} kHz)" if bus_hz else f"🚀 Débit soutenu sur {probe['url']}")
+    for name, w in probe['workloads'].items():
+        load = f", bus occupé à {w['bus_load'] * 100:.0f} %" if w['bus_load'] is not None else ''
+        print(f"   {name:12s}: {w['tps']:7.0f} tx/s ({w['tps_min']:.0f}-{w['tps_max']:.0f}), "
+              f"{w['bytes_per_s']:7.0f} octets/s, {w['errors']} erreur(s){load}")
+
+    slave = probe['slave']
+    if slave and slave['delta']:
+        d = slave['delta']
+        print(f"   Esclave : {d['overruns']} débordement(s), {d['bus_errors']} erreur(s) de bus, "
+              f"{d['slow_isr']} ISR au-delà de {ISR_BUDGET_US} µs, pire ISR {slave['isr_max_us']} µs")
+
+
+def display_system_stats(stats):
+    """Affiche les statistiques d'exécution du firmware sur une ligne"""
+    if stats is None:
+        print("❌ Impossible de récupérer la charge CPU")
+        return
+
+    print(f"🖥️  CPU 1s: {stats['cpu_load_1s']:3d}% | "
+          f"60s: {stats['cpu_load_60s']:3d}% | "
+          f"Écart tick max: {stats['tick_gap_max_us']} µs")
+
+
+def display_health(health):
+    """Affiche une alerte si le heartbeat du firmware est bloqué"""
+    if health is None:
+        print("❌ Impossible de lire le heartbeat")
+    elif health['stalled']:
+        print(f"🚨 Heartbeat bloqué ({health['heartbeat']}) : une tâche du firmware ne répond plus")
+
+
+def events_mode(master, interval=5.0):
+    """Vide périodiquement la FIFO d'événements du firmware et les affiche
+
+    Args:
+        master: Instance ParkingMaster
+        interval: Intervalle entre deux vidages (secondes)
+    """
+    print(f"📜 Journal des événements (vidage toutes les {interval}s, Ctrl+C pour quitter)")
+    lost = 0
+    try:
+        while True:
+            for event in master.read_events():
+                name = f"car[{event['spot']}]" if 'spot' in event else event['type']
+                print(f"[{event['timestamp_ms'] / 1000:10.3f} s] {name:8} = {event['value']}")
+            if master.events_lost != lost:
+                print(f"⚠️  {master.events_lost - lost} événement(s) perdu(s) (FIFO pleine)")
+                lost = master.events_lost
+            time.sleep(interval)
+    except KeyboardInterrupt:
+        print("\n👋 Arrêt du journal")
+
+
+def telemetry_mode(port, baud):
+    """Affiche la télémétrie série au fil de l'eau (sans passer par l'I2C)"""
+    stream = TelemetryStream(port, baud)
+    print(f"📡 Télémétrie sur {port} à {baud} bauds (Ctrl+C pour quitter)")
+    last_state = None
+    try:
+        while True:
+            record = stream.read()
+            if record is None:
+                print("⚠️  Aucune trame (firmware compilé sans TELEMETRY=1 ?)")
+                continue
+            stamp = f"[{record['uptime_ms'] / 1000:10.3f} s]"
+            if record['type'] == 'state':
+                # Instantané toutes les 100 ms : n'affiche que les changements
+                state = {k: v for k, v in record.items() if k not in ('uptime_ms', 'registers')}
+                if state != last_state:
+                    print(f"{stamp} état    : voiture={int(state['car_detected'])} "
+                          f"servo={state['servo_angle']}° leds={state['led_state']:#x} "
+                          f"places libres={state['free_spots']}")
+                    last_state = state
+            elif record['type'] == 'lost':
+                print(f"{stamp} ⚠️  {record['count']} enregistrement(s) perdu(s) (buffer plein)")
+            else:
+                print(f"{stamp} {record['type']:8} = {record.get('value', record.get('data'))}")
+    except KeyboardInterrupt:
+        print(f"\n👋 Arrêt : {stream.frames} trame(s), {stream.corrupted} rejetée(s), "
+              f"{stream.lost} enregistrement(s) perdu(s)")
+    finally:
+        stream.close()
+
+
+def display_spots(master):
+    """Affiche l'occupation de toutes les places"""
+    occupancy = master.get_occupancy()
+    if occupancy is None:
+        print("❌ Impossible de lire l'occupation")
+        return
+
+    print(f"🅿️  {occupancy['free_spots']}/{len(occupancy['occupied'])} place(s) libre(s)")
+    for n in range(len(occupancy['occupied'])):
+        spot = master.get_spot(n)
+        if spot is None:
+            continue
+        state = 'OCCUPÉE' if spot['car_detected'] else ('libre' if spot['released'] else 'libération')
+        print(f"  Place {n:2d} : {state:11s} {spot['arrivals']:5d} arrivée(s), "
+              f"dernier changement à {spot['last_change_ms'] / 1000:.1f} s")
+
+
+def display_policy_stats(stats):
+    """Affiche les compteurs des politiques de maintien de la barrière"""
+    if stats is None:
+        print("❌ Impossible de lire les compteurs de politique")
+        return
+
+    gap = f"{stats['avg_gap_s']} s" if stats['avg_gap_s'] is not None else "-"
+    print(f"🚧 Politique active : {stats['active']} (maintien {stats['hold_ms']} ms, "
+          f"écart moyen entre arrivées {gap})")
+    for name in HOLD_POLICIES:
+        p = stats[name]
+        rate = f"{p['cars_per_hour']:.1f}/h" if p['cars_per_hour'] is not None else "-"
+        ratio = f"{p['cycles_per_car']:.2f}" if p['cycles_per_car'] is not None else "-"
+        print(f"  {name:9s}: {p['cars_served']:5d} voitures, {p['barrier_cycles']:5d} cycles "
+              f"({ratio} par voiture), {p['active_min']} min, {rate}")
+
+
+def display_approach_stats(stats):
+    """Affiche les temps d'attente et de dégagement mesurés à la barrière"""
+    if stats is None:
+        print("❌ Impossible de lire les mesures de pré-ouverture")
+        return
+
+    direct = stats['cars'] - stats['preopened_cars']
+    print(f"🚗 {stats['cars']} voiture(s) dont {stats['preopened_cars']} avec pré-ouverture, "
+          f"{stats['preopen_timeouts']} pré-ouverture(s) sans voiture")
+    print(f"   Dernière voiture : attente {stats['last_wait_ms']} ms, dégagement {stats['last_clear_ms']} ms")
+    if direct:
+        print(f"   Attente moyenne sans pré-ouverture : {stats['avg_wait_ms']} ms")
+    if stats['preopened_cars']:
+        print(f"   Attente moyenne avec pré-ouverture : {stats['avg_wait_preopened_ms']} ms")
+    if stats['cars']:
+        print(f"   Dégagement moyen : {stats['avg_clear_ms']} ms")
+
+
+def dwell_bin_label(i):
+    """Libellé d'une classe de l'histogramme des durées de stationnement"""
+    if i == 0:
+        return "< 1 min"
+    if i == OCCUPANCY_BINS - 1:
+        return f">= {1 << (i - 1)} min"
+    low, high = 1 << (i - 1), (1 << i) - 1
+    return f"{low} min" if low == high else f"{low}-{high} min"
+
+
+def display_occupancy_stats(stats):
+    """Affiche les statistiques d'occupation"""
+    if stats is None:
+        print("❌ Impossible de lire les statistiques d'occupation")
+        return
+
+    print(f"🅿️  {stats['occupied']} place(s) occupée(s), taux d'occupation {stats['utilisation_pct']} % sur 1 h")
+    print(f"   {stats['entries']} arrivée(s), {stats['departures']} départ(s), "
+          f"plus long stationnement en cours : {stats['longest_dwell_s'] // 60} min")
+    for i, count in enumerate(stats['dwell_hist']):
+        if count:
+            print(f"   {dwell_bin_label(i):>12s} : {count}")
+
+
+def display_traffic(traffic):
+    """Affiche le comptage entrées/sorties"""
+    if traffic is None:
+        print("❌ Impossible de lire le comptage")
+        return
+
+    print(f"🚦 {traffic['occupied']} place(s) occupée(s) : {traffic['entries']} entrée(s), "
+          f"{traffic['exits']} sortie(s), {traffic['aborted']} demi-tour(s)")
+    if traffic['last_direction']:
+        print(f"   Dernier passage : {traffic['last_direction']} à {traffic['last_speed_kmh']:.1f} km/h")
+    if traffic['edges_lost']:
+        print(f"⚠️  {traffic['edges_lost']} front(s) perdu(s)")
+
+
+def display_trace(trace):
+    """Affiche la chronologie des tâches et les statistiques de la trace du noyau"""
+    if trace is None:
+        print("❌ Impossible de lire la trace")
+        return
+
+    events, overwritten = trace
+    stats = trace_statistics(events)
+    if not stats['timeline']:
+        print("Trace vide")
+        return
+
+    print(f"🧵 {len(events)} événements" + (" (les plus anciens ont été écrasés)" if overwritten else ""))
+    start = stats['timeline'][0][1]
+    for name, begin, duration in stats['timeline']:
+        print(f"  {(begin - start) / 1000:9.3f} ms  {name:5s} {duration:7d} µs")
+
+    span = sum(d for _, _, d in stats['timeline'])
+    print(f"\nTâches (sur {span / 1000:.1f} ms) :")
+    for name, t in sorted(stats['tasks'].items(), key=lambda kv: -kv[1]['total_us']):
+        print(f"  {name:5s} {t['runs']:4d} exécution(s), {t['total_us']:7d} µs ({t['share_pct']:.1f} %), "
+              f"max {t['max_us']} µs")
+    for title, group in (("Interruptions", stats['isrs']), ("Files (give -> take)", stats['queues'])):
+        if group:
+            print(f"{title} :")
+            for name, g in group.items():
+                print(f"  {name:6s} {g['count']:4d} fois, moyenne {g['avg_us']:.0f} µs, max {g['max_us']} µs")
+
+
+def display_journal(records):
+    """Affiche le journal EEPROM relu depuis le firmware"""
+    if records is None:
+        print("❌ Impossible de relire le journal")
+        return
+
+    print(f"💾 Journal EEPROM : {len(records)} enregistrement(s)")
+    for r in records:
+        flags = [name for name in JOURNAL_STATE_BITS if r[name]]
+        print(f"  #{r['seq']:5d} boot {r['boot']:3d} +{r['uptime_s']:7d}s  {', '.join(flags) or '-'}")
+
+
 def monitor_mode(master, interval=1.0, force=False):
     """Mode de monitoring continu
 
@@ -244,13 +2197,22 @@ def monitor_mode(master, interval=1.0, force=False):
         print(f"📡 Mode FORCE : Lecture toutes les {interval}s (même si pas de changement)")
     else:
         print(f"📡 Mode OPTIMISÉ : Affichage uniquement si changement détecté")
+    reset = master.get_reset_info()
+    if reset is not None:
+        print(f"🔌 Dernier reset : {'/'.join(reset['reset_cause']) or 'inconnu'} "
+              f"({reset['reboot_count']} redémarrage(s) depuis la mise sous tension)")
     print()
 
     try:
         while True:
             status = master.get_all_status(force=force)
             display_status(status)
-            time.sleep(interval)
+            display_system_stats(master.get_system_stats())
+            display_health(master.check_heartbeat())
+            if force:
+                time.sleep(interval)
+            else:
+                master.wait_for_change(interval)
     except KeyboardInterrupt:
         print("\n👋 Arrêt du monitoring")
 
@@ -259,16 +2221,58 @@ def main():
     parser = argparse.ArgumentParser(description='Master I2C pour système de parking Arduino')
     parser.add_argument('--bus', type=int, default=I2C_BUS, help='Numéro du bus I2C')
     parser.add_argument('--addr', type=int, default=SLAVE_ADDRESS, help='Adresse I2C du slave (hex)')
+    parser.add_argument('--link', metavar='URL',
+                        help='Transport : i2c:1@0x32, serial:/dev/ttyACM0 ou sim: (défaut : --bus/--addr)')
+    parser.add_argument('--bus-stats', action='store_true',
+                        help='Compteurs I2C du firmware et latence/erreurs du master par registre')
+    parser.add_argument('--speed-probe', action='store_true',
+                        help='Mesure les transactions/s soutenues (à relancer à chaque fréquence du bus)')
+    parser.add_argument('--link-stats', type=int, nargs='?', const=100, metavar='N',
+                        help='Lit N fois le status (100 par défaut) et affiche la latence du transport')
     parser.add_argument('--monitor', action='store_true', help='Mode monitoring continu')
     parser.add_argument('--interval', type=float, default=1.0, help='Intervalle de monitoring (secondes)')
     parser.add_argument('--force', action='store_true', help='Force la lecture même si pas de changement')
+    parser.add_argument('--events', action='store_true', help='Affiche le journal des événements horodatés')
+    parser.add_argument('--journal', action='store_true', help='Relit le journal EEPROM (persistant)')
+    parser.add_argument('--spots', action='store_true', help='Affiche l\'occupation de chaque place')
+    parser.add_argument('--policy', choices=list(HOLD_POLICIES),
+                        help='Change la politique de maintien de la barrière')
+    parser.add_argument('--policy-stats', action='store_true',
+                        help='Affiche les compteurs par politique de maintien')
+    parser.add_argument('--traffic', action='store_true', help='Affiche le comptage entrées/sorties')
+    parser.add_argument('--approach', action='store_true',
+                        help="Affiche les temps d'attente et de dégagement (pré-ouverture)")
+    parser.add_argument('--occupancy', action='store_true',
+                        help="Affiche les statistiques d'occupation (arrivées, durées, taux)")
+    parser.add_argument('--clear', action='store_true',
+                        help='Avec --occupancy : remet les compteurs à zéro à la lecture')
+    parser.add_argument('--program', metavar='PROG',
+                        help='Lance un programme de la barrière, ex. "move 120; wait 30000; auto"')
+    parser.add_argument('--stop-program', action='store_true',
+                        help='Arrête le programme et revient au mode automatique')
+    parser.add_argument('--program-status', action='store_true', help='Etat du programme de la barrière')
+    parser.add_argument('--trace', action='store_true',
+                        help='Relit la trace du noyau (firmware make TRACE=1) : chronologie et latences')
+    parser.add_argument('--telemetry', metavar='PORT', nargs='?', const=TELEMETRY_PORT,
+                        help=f'Lit la télémétrie série (firmware make TELEMETRY=1), défaut {TELEMETRY_PORT}')
+    parser.add_argument('--baud', type=int, default=TELEMETRY_BAUD, help='Débit de la télémétrie série')
     parser.add_argument('--servo', type=int, help='Définir l\'angle du servo (0-180) ou 255 pour mode auto')
     parser.add_argument('--reset', action='store_true', help='Réinitialiser le système')
+    parser.add_argument('--get', metavar='PARAM', choices=list(PARAMS) + ['all'],
+                        help='Lit un paramètre du firmware (ou all)')
+    parser.add_argument('--set', metavar='PARAM=VALUE', action='append',
+                        help='Modifie un paramètre du firmware (répétable, appliqué d\'un coup)')
+    parser.add_argument('--defaults', action='store_true', help='Restaure les paramètres par défaut')
     
     args = parser.parse_args()
-    
+
+    # La télémétrie n'utilise pas le bus I2C
+    if args.telemetry:
+        telemetry_mode(args.telemetry, args.baud)
+        return
+
     # Créer l'instance du master
-    master = ParkingMaster(bus_num=args.bus, slave_addr=args.addr)
+    master = ParkingMaster(bus_num=args.bus, slave_addr=args.addr, link=args.link)
     
     try:
         if args.reset:
@@ -288,9 +2292,109 @@ def main():
             else:
                 print("❌ Échec de l'envoi de la commande")
         
+        elif args.speed_probe:
+            display_speed_probe(master.probe_speed())
+
+        elif args.bus_stats:
+            master.get_all_status(force=True)
+            display_bus_stats(master)
+
+        elif args.link_stats:
+            for _ in range(args.link_stats):
+                master.get_all_status(force=True)
+            display_link_stats(master.link_stats())
+
         elif args.monitor:
             monitor_mode(master, args.interval, force=args.force)
 
+        elif args.events:
+            events_mode(master, args.interval)
+
+        elif args.journal:
+            display_journal(master.read_journal())
+
+        elif args.trace:
+            display_trace(master.read_trace())
+
+        elif args.spots:
+            display_spots(master)
+
+        elif args.policy:
+            if master.set_hold_policy(args.policy):
+                print(f"✓ Politique de maintien : {args.policy}")
+            else:
+                print("❌ Échec du changement de politique")
+
+        elif args.policy_stats:
+            display_policy_stats(master.get_policy_stats())
+
+        elif args.traffic:
+            display_traffic(master.get_traffic())
+
+        elif args.approach:
+            display_approach_stats(master.get_approach_stats())
+
+        elif args.program:
+            try:
+                ok = master.run_program(args.program)
+            except ValueError as e:
+                print(f"❌ Programme invalide : {e}")
+            else:
+                if ok:
+                    time.sleep(0.1)     # Pris en compte au prochain cycle de la tâche servo
+                    status = master.get_program_status()
+                    print(f"✓ Programme envoyé : {status['status'] if status else '?'}")
+                else:
+                    print("❌ Échec de l'envoi du programme")
+
+        elif args.stop_program:
+            if master.stop_program():
+                print("✓ Programme arrêté, mode automatique")
+            else:
+                print("❌ Échec de l'arrêt du programme")
+
+        elif args.program_status:
+            status = master.get_program_status()
+            if status is None:
+                print("❌ Impossible de lire l'état du programme")
+            else:
+                print(f"📜 Programme {status['status']}, instruction à l'octet {status['pc']}, "
+                      f"{status['loops_left']} tour(s) de boucle restant(s)")
+
+        elif args.occupancy:
+            display_occupancy_stats(master.get_occupancy_stats(reset=args.clear))
+
+        elif args.get == 'all':
+            values = master.get_all_params()
+            if values is None:
+                print("❌ Impossible de lire les paramètres")
+            else:
+                for name, value in values.items():
+                    print(f"{name:16s}: {value}")
+
+        elif args.get:
+            value = master.get_param(args.get)
+            print(f"{args.get:16s}: {value if value is not None else '❌ erreur'}")
+
+        elif args.set:
+            values = {}
+            for item in args.set:
+                name, _, value = item.partition('=')
+                if name not in PARAMS or not value:
+                    parser.error(f"paramètre inconnu ou valeur manquante : {item}")
+                values[name] = int(value, 0)
+
+            if master.set_params(values):
+                print("✓ Paramètres appliqués et sauvegardés")
+            else:
+                print("❌ Échec de la modification des paramètres")
+
+        elif args.defaults:
+            if master.reset_params():
+                print("✓ Paramètres par défaut restaurés")
+            else:
+                print("❌ Échec de la restauration des paramètres")
+
         else:
             # Lecture unique du status (toujours en mode force)
             status = master.get_all_status(force=True)
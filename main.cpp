@@ -1,5 +1,7 @@
+#include <stddef.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/crc16.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -9,13 +11,42 @@
 #include "servo.h"
 #include "lcd_grove.h"
 #include "soft_i2c.h"
-
+#include "sysmon.h"
+#include "supervisor.h"
+#include "event_log.h"
+#include "journal.h"
+#include "params.h"
+#include "shift_in.h"
+#include "pin.h"
+#include "hold_policy.h"
+#include "traffic.h"
+#include "preopen.h"
+#include "occupancy.h"
+#include "barrier_prog.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "parking_controller.h"
+
+
+// ------------ PARKING SPOTS ------------
+// SPOT_COUNT (Makefile) sensors. With a single spot it is the IR sensor on
+// PB0; otherwise all spots are sampled at once through 74HC165 shift
+// registers (drivers/shift_in.h). Spot 0 is the barrier lane: it drives the
+// servo and the traffic LEDs, the other spots are occupancy only.
+#ifndef SPOT_COUNT
+#define SPOT_COUNT 1
+#endif
+#define BARRIER_SPOT        0
+#define SHIFT_IN_CHIPS      ((SPOT_COUNT + 7) / 8)
+
+static_assert(SPOT_COUNT >= 1 && SPOT_COUNT <= 16, "the occupancy bitmap is 16 bits");
 
 // ------------ PIN DEFINITIONS ------------
-#define RED_LED     PD2
-#define GREEN_LED   PD4
-#define WHITE_LED   PD3     // <<< moved from D6 to D3
-#define LIGHT_PIN   PC0
+typedef Pin<PortD, PD2> RedLed;
+typedef Pin<PortD, PD4> GreenLed;
+typedef Pin<PortD, PD3> WhiteLed;   // <<< moved from D6 to D3
+typedef Pin<PortC, PC0> LightPin;
+typedef Pin<PortD, PD7> ApproachPin; // Optional approach-zone sensor, LOW = car (see preopen.h)
 
 // ------------ I2C REGISTER DEFINITIONS ------------
 #define REG_CAR_STATE       0
@@ -26,42 +57,282 @@
 #define REG_SYSTEM_STATUS   5
 #define REG_SERVO_COMMAND   6  // Commande manuelle du servo depuis le master
 #define REG_CHANGE_FLAG     7  // Flag indiquant qu'une donnée a changé (1=changé, 0=stable)
-
-#define BARRIER_OPEN_DURATION 100 // 100 * 50ms = 5000ms = 5 seconds
+#define REG_CPU_LOAD_1S     8  // Charge CPU sur la dernière seconde (%)
+#define REG_CPU_LOAD_60S    9  // Charge CPU moyenne sur ~60 s (%)
+#define REG_TICK_GAP_MAX_L  10 // Pire écart tick-à-tick en µs (octet bas)
+#define REG_TICK_GAP_MAX_H  11 // Pire écart tick-à-tick en µs (octet haut)
+#define REG_HEARTBEAT       12 // Incrémenté quand toutes les tâches ont répondu
+#define REG_RESET_CAUSE     13 // MCUSR au démarrage (bit0=POR, bit1=EXT, bit2=BOR, bit3=WDT, bit7=débordement de pile)
+#define REG_REBOOT_COUNT    14 // Redémarrages depuis la mise sous tension
+#define REG_HOLD_POLICY     15 // Politique de maintien de la barrière (HOLD_POLICY_*)
+#define REG_UPTIME_0        16 // Uptime en ms, 32 bits little-endian (16-19)
+                               // Lire 16 fige uptime + last change (lecture en rafale de 8 octets)
+#define REG_LAST_CHANGE_0   20 // Uptime du dernier changement d'état, 32 bits (20-23)
+#define REG_EVENT_FIFO      24 // FIFO des événements horodatés (lecture en rafale ; écriture = acquittement, voir event_log.h)
+#define REG_JOURNAL_STREAM  25 // Relecture du journal EEPROM (lecture en rafale, voir journal.h)
+#define REG_JOURNAL_CTRL    26 // Ecrire 1 pour rembobiner la relecture (remis à 0 une fois fait)
+#define REG_JOURNAL_COUNT   27 // Nombre d'enregistrements dans le journal EEPROM
+#define REG_PARAM_ID        28 // Fenêtre paramètres : identifiant (voir params.h)
+#define REG_PARAM_VALUE_L   29 // Fenêtre paramètres : valeur (octet bas)
+#define REG_PARAM_VALUE_H   30 // Fenêtre paramètres : valeur (octet haut)
+#define REG_PARAM_CTRL      31 // Commande PARAM_CMD_*, remis à 0 une fois faite
+#define REG_OCCUPANCY_L     32 // Bitmap d'occupation, bit n = place n occupée (octet bas)
+#define REG_OCCUPANCY_H     33 // Bitmap d'occupation (octet haut)
+#define REG_SPOT_COUNT      34 // Nombre de places gérées
+#define REG_FREE_SPOTS      35 // Places libres depuis au moins barrier_hold_ms
+#define REG_STATUS_FRAME    36 // Instantané du status avec PEC (lecture en rafale, voir status_frame_t)
+
+// ------------ I2C REGISTER PAGES ------------
+// Select with [SOFT_I2C_PAGE_SELECT, page]. Page 0 is the register map above.
+#define PAGE_STATUS         0
+#define PAGE_CONFIG         1  // Live parameter values, PARAM_COUNT x uint16 LE (read-only)
+#define PAGE_STATS          2  // sysmon_stats_t
+#define PAGE_EVENTS         3  // Same stream as REG_EVENT_FIFO, from any register
+#define PAGE_JOURNAL        4  // Same stream as REG_JOURNAL_STREAM, from any register
+#define PAGE_POLICY         5  // hold_stats_t
+#define PAGE_TRAFFIC        6  // traffic_stats_t
+#define PAGE_APPROACH       7  // preopen_stats_t
+#define PAGE_OCCUPANCY      8  // occupancy_stats_t, one 32-byte burst
+#define PAGE_OCCUPANCY_RESET 9 // occupancy_reset_t: names a verified page 8 burst to clear its counters
+#define PAGE_PROGRAM        10 // prog_slot_t, barrier program uploaded by the master
+#define PAGE_TRACE          11 // Kernel trace dump (TRACE=1 builds only, see trace.h)
+#define PAGE_BUS            12 // soft_i2c_stats_t, slave-side bus counters
+#define PAGE_SPOT_0         0x10 // spot_t of spot n at page PAGE_SPOT_0 + n
+
+// ------------ SYSTEM STATUS VALUES ------------
+#define SYS_STATUS_OK       0x01 // All tasks checked in during the last round
+#define SYS_STATUS_STALLED  0x02 // At least one task missed its check-in
+#define SYS_STATUS_BOOTING  0x80 // I2C is up, tasks not all running yet
+
+// ------------ SUPERVISED TASKS ------------
+#define TASK_IR             (1<<0)
+#define TASK_LIGHT          (1<<1)
+#define TASK_SERVO          (1<<2)
+#define TASK_LED            (1<<3)
+#define TASK_JOURNAL        (1<<4)
+#define TASK_TELEMETRY      (1<<5)
+#if TELEMETRY_ENABLE
+#define TASK_ALL            (TASK_IR | TASK_LIGHT | TASK_SERVO | TASK_LED | TASK_JOURNAL | TASK_TELEMETRY)
+#else
+#define TASK_ALL            (TASK_IR | TASK_LIGHT | TASK_SERVO | TASK_LED | TASK_JOURNAL)
+#endif
+
+#define SERVO_PERIOD_MS     50 // The release counter counts servo periods
+
+#define TELEMETRY_STATE_MS  100 // Register snapshot period on the serial link
+
+#define JOURNAL_CMD_REWIND      1
+#define JOURNAL_COMMIT_INTERVAL 2000 // ms, state changes within this window are coalesced
+
+// ------------ PARAMETER WINDOW COMMANDS ------------
+#define PARAM_CMD_READ      1    // Window value <- live value of REG_PARAM_ID
+#define PARAM_CMD_WRITE     2    // Stage the window value (range checked)
+#define PARAM_CMD_COMMIT    3    // Apply every staged value at once and save them
+#define PARAM_CMD_DEFAULTS  4    // Stage the default values (commit to apply)
+#define PARAM_CMD_ERROR     0x80 // Reply: unknown command/parameter or value out of range
 
 
 static SemaphoreHandle_t lcdSem;
 
-volatile uint8_t car_state = 0;
-volatile uint8_t prev_car_state = 255;
+// Per-spot state, served as I2C page PAGE_SPOT_0 + n
+typedef struct
+{
+    uint8_t  car;                 // 1 = occupied
+    uint8_t  released;            // Free for at least barrier_hold_ms
+    uint8_t  release_counter;     // Servo periods since the car left
+    uint8_t  reserved;
+    uint16_t arrivals;            // Cars seen since boot
+    uint32_t last_change_ms;      // Uptime of the last arrival/departure
+} spot_t;
+
+volatile spot_t spots[SPOT_COUNT];
+
+// Status snapshot served at REG_STATUS_FRAME, rebuilt by the servo task every
+// cycle. The last byte is the SMBus PEC (CRC-8, poly 0x07) of the block read
+// as it appears on the bus (address+W, REG_STATUS_FRAME, address+R, frame):
+// it is computed once per snapshot, the I2C interrupt only copies the frame.
+typedef struct
+{
+    uint8_t  seq;                 // Incremented by every snapshot
+    uint8_t  regs[6];             // REG_CAR_STATE .. REG_SYSTEM_STATUS
+    uint8_t  occupancy[2];        // REG_OCCUPANCY_L/H
+    uint8_t  free_spots;          // REG_FREE_SPOTS
+    uint32_t uptime_ms;           // Snapshot time
+    uint32_t last_change_ms;
+    uint8_t  pec;
+} status_frame_t;
+
+static status_frame_t status_frames[2];        // Double buffer: the ISR reads the live one
+static volatile uint8_t status_frame_live = 0;
+static uint8_t status_frame_seed;              // PEC of the address and command bytes
+
+typedef ParkingController<SPOT_COUNT> Controller;
+static Controller controller;                 // Owned by the servo task
+
 volatile uint16_t current_servo_angle = 0;
-volatile uint8_t current_release_counter = 0; // Shared with LED task
 volatile uint8_t is_dark_state = 0;           // Shared with LED task
+volatile uint8_t is_manual_mode = 0;          // Shared with journal task
 volatile uint8_t prev_light_state = 255;
-volatile uint8_t prev_servo_angle = 255;
 volatile uint8_t prev_led_state = 255;
+static uint32_t last_change_ms = 0;           // Timestamp of the last state change
 
 // ------------ INIT ------------
 static void leds_init(void)
 {
-    DDRD |= (1<<RED_LED) | (1<<GREEN_LED) | (1<<WHITE_LED);
+    RedLed::output();
+    GreenLed::output();
+    WhiteLed::output();
 }
 
 static void light_sensor_init(void)
 {
-    DDRC &= ~(1<<LIGHT_PIN);
-    PORTC |= (1<<LIGHT_PIN);
+    LightPin::pullup();
 }
 
 static uint8_t is_dark(void)
 {
-    return !(PINC & (1<<LIGHT_PIN));
+    return !LightPin::read();
 }
 
-// Helper to mark data as changed
-static void mark_data_changed(void)
+// Helper to mark data as changed and log the transition
+static uint32_t mark_data_changed(uint8_t event, uint8_t value)
 {
+    uint32_t now = sysmon_uptime_ms();
+
+    taskENTER_CRITICAL();
+    last_change_ms = now;
+    taskEXIT_CRITICAL();
+
+    event_log_push(now, event, value);
+
+    telemetry_push_event(event, value);
+
     soft_i2c_set_register(REG_CHANGE_FLAG, 1);
+    return now;
+}
+
+// Samples every spot at the same instant. Bit n = spot n occupied.
+static uint16_t read_occupancy(void)
+{
+#if SPOT_COUNT > 1
+    uint8_t raw[SHIFT_IN_CHIPS];
+    uint16_t bitmap = 0;
+
+    shift_in_read(raw, SHIFT_IN_CHIPS);
+    for (uint8_t i = 0; i < SHIFT_IN_CHIPS; i++)
+        bitmap |= (uint16_t)raw[i] << (8 * i);
+
+    // FC-51 sensors pull their output LOW when a car is detected
+    return ~bitmap & ((1UL << SPOT_COUNT) - 1);
+#else
+    return ir_detect();
+#endif
+}
+
+// Task periods and timings are parameters, re-read every cycle so that a
+// commit from the master applies without restarting anything.
+static void delay_ms_param(uint8_t id)
+{
+    vTaskDelay((TickType_t)params_get(id) / portTICK_PERIOD_MS);
+}
+
+// Executes a command written by the master into the parameter window.
+static void handle_param_command(void)
+{
+    uint8_t cmd = soft_i2c_get_register(REG_PARAM_CTRL);
+    if (cmd == 0 || cmd == PARAM_CMD_ERROR)
+        return;
+
+    uint8_t id = soft_i2c_get_register(REG_PARAM_ID);
+    uint16_t value = soft_i2c_get_register(REG_PARAM_VALUE_L) |
+                     ((uint16_t)soft_i2c_get_register(REG_PARAM_VALUE_H) << 8);
+    uint8_t ok = 1;
+
+    switch (cmd)
+    {
+    case PARAM_CMD_READ:
+        ok = id < PARAM_COUNT;
+        value = params_get(id);
+        soft_i2c_set_register(REG_PARAM_VALUE_L, value & 0xFF);
+        soft_i2c_set_register(REG_PARAM_VALUE_H, value >> 8);
+        break;
+    case PARAM_CMD_WRITE:
+        ok = params_stage(id, value);
+        break;
+    case PARAM_CMD_COMMIT:
+        params_commit();
+        // A commit followed by a journal append can outlast a supervisor round
+        supervisor_checkin(TASK_JOURNAL);
+        break;
+    case PARAM_CMD_DEFAULTS:
+        params_stage_defaults();
+        break;
+    default:
+        ok = 0;
+        break;
+    }
+
+    soft_i2c_set_register(REG_PARAM_CTRL, ok ? 0 : PARAM_CMD_ERROR);
+}
+
+// Called from the I2C interrupt when the master starts reading at
+// REG_UPTIME_0: both 32-bit timestamps are latched together so that a burst
+// read (or reading 16 first, then the others) returns a consistent snapshot.
+static void latch_timestamps(void)
+{
+    uint32_t now = sysmon_uptime_ms();
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        soft_i2c_set_register(REG_UPTIME_0 + i, (uint8_t)(now >> (8 * i)));
+        soft_i2c_set_register(REG_LAST_CHANGE_0 + i, (uint8_t)(last_change_ms >> (8 * i)));
+    }
+}
+
+static void status_frame_init(uint8_t address)
+{
+    status_frame_seed = _crc8_ccitt_update(0, address << 1);
+    status_frame_seed = _crc8_ccitt_update(status_frame_seed, REG_STATUS_FRAME);
+    status_frame_seed = _crc8_ccitt_update(status_frame_seed, (address << 1) | 1);
+}
+
+// Builds the next snapshot in the idle buffer, then publishes it
+static void status_frame_update(void)
+{
+    uint8_t next = status_frame_live ^ 1;
+    status_frame_t *frame = &status_frames[next];
+
+    frame->seq = status_frames[status_frame_live].seq + 1;
+    for (uint8_t i = 0; i < sizeof(frame->regs); i++)
+        frame->regs[i] = soft_i2c_get_register(REG_CAR_STATE + i);
+    frame->occupancy[0] = soft_i2c_get_register(REG_OCCUPANCY_L);
+    frame->occupancy[1] = soft_i2c_get_register(REG_OCCUPANCY_H);
+    frame->free_spots = soft_i2c_get_register(REG_FREE_SPOTS);
+    frame->uptime_ms = sysmon_uptime_ms();
+    taskENTER_CRITICAL();
+    frame->last_change_ms = last_change_ms;
+    taskEXIT_CRITICAL();
+
+    uint8_t pec = status_frame_seed;
+    for (uint8_t i = 0; i < offsetof(status_frame_t, pec); i++)
+        pec = _crc8_ccitt_update(pec, ((const uint8_t *)frame)[i]);
+    frame->pec = pec;
+
+    status_frame_live = next;
+}
+
+// Stream callback of REG_EVENT_FIFO and PAGE_EVENTS (I2C interrupt). The
+// master acknowledges each batch by writing the next sequence number it
+// expects into the bank byte of REG_EVENT_FIFO.
+static void event_fifo_send(void)
+{
+    event_log_send_batch(soft_i2c_get_register(REG_EVENT_FIFO));
+}
+
+// Stream callback of REG_STATUS_FRAME (I2C interrupt)
+static void status_frame_send(void)
+{
+    soft_i2c_write((const uint8_t *)&status_frames[status_frame_live], sizeof(status_frame_t));
 }
 
 // ===================================================
@@ -69,24 +340,71 @@ static void mark_data_changed(void)
 // ===================================================
 
 // Task 1: Infrared Sensor Task
-// Reads the IR sensor and updates the car presence state.
+// Samples the occupancy sensors and updates the per-spot presence state.
 static void vIrTask(void *p)
 {
+#if SPOT_COUNT > 1
+    shift_in_init();
+#else
+    ir_init();
+#endif
+    traffic_init();     // Entry/exit beams, needs the tick timer running
+
     for(;;)
     {
-        car_state = ir_detect();
+        // Entry/exit counting from the timestamped beam edges
+        uint8_t direction = traffic_process(params_get(PARAM_BEAM_SPACING_MM));
+        if (direction)
+            mark_data_changed(EVENT_DIRECTION, direction);
+
+        uint16_t occupancy = read_occupancy();
 
-        if (car_state != prev_car_state)
+        for (uint8_t n = 0; n < SPOT_COUNT; n++)
         {
-            prev_car_state = car_state;
-            xSemaphoreGive(lcdSem);
-            mark_data_changed();  // Mark that data has changed
+            uint8_t car = (occupancy >> n) & 1;
+            if (car == spots[n].car)
+                continue;
+
+            if (n == BARRIER_SPOT)
+                xSemaphoreGive(lcdSem);
+            // Event value: bit 0 = car, bits 1-7 = spot (spot 0 reads as before)
+            uint32_t now = mark_data_changed(EVENT_CAR, (n << 1) | car);
+            if (car)
+                occupancy_arrival();
+            else
+                occupancy_departure(now - spots[n].last_change_ms);
+
+            taskENTER_CRITICAL();
+            spots[n].car = car;
+            if (car)
+                spots[n].arrivals++;
+            spots[n].last_change_ms = now;
+            taskEXIT_CRITICAL();
         }
 
-        // Update I2C register
-        soft_i2c_set_register(REG_CAR_STATE, car_state);
+        // On-device statistics, so that the master does not have to sample
+        uint32_t now = sysmon_uptime_ms();
+        uint32_t longest_dwell = 0;
+        uint8_t occupied = 0;
+        for (uint8_t n = 0; n < SPOT_COUNT; n++)
+        {
+            if (!spots[n].car)
+                continue;
+            occupied++;
+            if (now - spots[n].last_change_ms > longest_dwell)
+                longest_dwell = now - spots[n].last_change_ms;
+        }
+        occupancy_update(occupied, SPOT_COUNT, longest_dwell, now);
 
-        vTaskDelay(pdMS_TO_TICKS(80));
+        // Update I2C registers (bitmap bytes together for a consistent burst)
+        soft_i2c_set_register(REG_CAR_STATE, spots[BARRIER_SPOT].car);
+        taskENTER_CRITICAL();
+        soft_i2c_set_register(REG_OCCUPANCY_L, occupancy & 0xFF);
+        soft_i2c_set_register(REG_OCCUPANCY_H, occupancy >> 8);
+        taskEXIT_CRITICAL();
+
+        supervisor_checkin(TASK_IR);
+        delay_ms_param(PARAM_IR_PERIOD_MS);
     }
 }
 
@@ -94,6 +412,8 @@ static void vIrTask(void *p)
 // Reads the light sensor and updates the dark/light state.
 static void vLightSensorTask(void *p)
 {
+    light_sensor_init();
+
     for(;;)
     {
         is_dark_state = is_dark();
@@ -102,177 +422,353 @@ static void vLightSensorTask(void *p)
         if (is_dark_state != prev_light_state)
         {
             prev_light_state = is_dark_state;
-            mark_data_changed();
+            mark_data_changed(EVENT_LIGHT, is_dark_state);
         }
 
         // Update I2C register
         soft_i2c_set_register(REG_LIGHT_STATE, is_dark_state);
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+        supervisor_checkin(TASK_LIGHT);
+        delay_ms_param(PARAM_LIGHT_PERIOD_MS);
     }
 }
 
 // Task 3: Servo Motor Task
-// Manages the Parking Logic (release counter) and Servo control (Auto/Manual).
+// Feeds the parking controller (release counters, Auto/Manual, barrier
+// target) with the sensors and commands, then applies its outputs.
 static void vServoTask(void *p)
 {
-    uint8_t release_counter = 0;
-    bool manual_servo_mode = false;
+    uint8_t prev_lane_car = 0;
+    uint8_t policy = params_get(PARAM_HOLD_POLICY);
+    TickType_t last_wake = xTaskGetTickCount();
+
+    servo_init();   // Timer0 OC0A on D6
+    ApproachPin::pullup();  // Reads "no car" when no sensor is fitted
+    soft_i2c_set_register(REG_HOLD_POLICY, policy);
+
+    // Static: 30 bytes the 130-byte task stack cannot spare
+    static ControllerInputs in;
+    static ControllerOutputs out;
 
     for(;;)
     {
-        // 1. Check for Manual Command via I2C
-        uint8_t servo_command = soft_i2c_get_register(REG_SERVO_COMMAND);
-        
-        // Command 255: Reactivate Automatic Mode
-        if (servo_command == 255)
-        {
-            manual_servo_mode = false;
-            soft_i2c_set_register(REG_SERVO_COMMAND, 0);  // Clear command
-        }
-        // Valid Angle Command (0-180): Activate Manual Mode
-        else if (servo_command != 0 && servo_command <= 180)
-        {
-            // Convertir les degrés (0-180) en unités servo (0-1620)
-            // 1 degré = 9 unités (180° * 9 = 1620)
-            uint16_t servo_units = servo_command * 9;
-            servo_set_angle(servo_units);
-            current_servo_angle = servo_units;
-            manual_servo_mode = true;
-            soft_i2c_set_register(REG_SERVO_COMMAND, 0);  // Clear command
-        }
 
-        // 2. Manage Release Counter (System State Logic)
-        // Counter runs regardless of manual mode to keep LED state consistent
-        if (car_state)
+        // 1. Manual command via I2C: 255 = back to Auto, 1-180 = angle.
+        // Either one also stops a running barrier program.
+        in.servo_command = soft_i2c_get_register(REG_SERVO_COMMAND);
+        if (Controller::is_servo_command(in.servo_command))
+            prog_stop();
+
+        // Barrier program: runs like a manual mode driven from the device
+        in.program = prog_poll_command(sysmon_uptime_ms());
+
+        // Hold policy selected by the master (invalid values are reverted)
+        uint8_t requested_policy = soft_i2c_get_register(REG_HOLD_POLICY);
+        if (requested_policy < HOLD_POLICY_COUNT)
+            policy = requested_policy;
+        else
+            soft_i2c_set_register(REG_HOLD_POLICY, policy);
+
+        uint32_t now = sysmon_uptime_ms();
+        volatile spot_t *lane = &spots[BARRIER_SPOT];
+        if (lane->car && !prev_lane_car)
         {
-            release_counter = 0;
+            hold_policy_arrival(policy, lane->last_change_ms);
+            preopen_car_arrived(lane->last_change_ms);
         }
-        else
+        else if (!lane->car && prev_lane_car)
         {
-            if (release_counter < BARRIER_OPEN_DURATION)
-                release_counter++;
+            preopen_car_left(lane->last_change_ms);
         }
-        current_release_counter = release_counter; // Update global for LED task
-
-        // 3. Automatic Servo Control
-        if (!manual_servo_mode)
+        prev_lane_car = lane->car;
+
+        // 2. Barrier program. Steps due before the next period run at their
+        // exact tick instead of waiting for the next cycle; the controller
+        // gets the last position.
+        uint16_t spent = 0;
+        in.program_angle = CONTROLLER_NO_MOVE;
+        while (prog_running())
         {
-            if (car_state)
-            {
-                // Car detected -> Open barrier
-                servo_set_angle(1080);
-                current_servo_angle = 1080;
-            }
-            else
+            uint8_t angle, resume_auto = 0;
+            uint16_t wait = prog_step(lane->car, sysmon_uptime_ms(), &angle, &resume_auto);
+
+            if (angle != PROG_NO_MOVE)
             {
-                // Car gone -> Wait for counter -> Close barrier
-                if (release_counter >= BARRIER_OPEN_DURATION)
-                {
-                    servo_set_angle(0);
-                    current_servo_angle = 0;
-                }
+                in.program_angle = angle;
+                current_servo_angle = angle * SERVO_UNITS_PER_DEG;
+                servo_set_angle(current_servo_angle);
             }
+            if (resume_auto)
+                in.program = PROG_CMD_STOP;
+
+            if (wait >= SERVO_PERIOD_MS - spent)
+                break;
+            vTaskDelay((TickType_t)wait / portTICK_PERIOD_MS);
+            spent += wait;
         }
 
-        // Check if servo angle changed
-        if ((uint8_t)current_servo_angle != prev_servo_angle)
+        // 3. Controller step. The hold policy only applies to the barrier
+        // lane; the approach sensor is only looked at in Auto.
+        in.occupancy = 0;
+        for (uint8_t n = 0; n < SPOT_COUNT; n++)
+            in.occupancy |= (uint16_t)spots[n].car << n;
+        in.lane_hold = hold_policy_update(policy, now) / SERVO_PERIOD_MS;
+        in.spot_hold = params_get(PARAM_BARRIER_HOLD_MS) / SERVO_PERIOD_MS;
+        in.open_angle = params_get(PARAM_OPEN_ANGLE);
+        in.preopen_angle = 0;
+        if (!controller.manual_after(in.servo_command, in.program))
+            in.preopen_angle = preopen_update(!ApproachPin::read(), lane->car, now);
+
+        controller.step(in, now, out);
+
+        if (out.command_done)
+            soft_i2c_set_register(REG_SERVO_COMMAND, 0);  // Clear command
+        if (out.barrier_cycle)
+            hold_policy_barrier_cycle(policy);
+        servo_set_angle(out.servo_units);
+        current_servo_angle = out.servo_units;
+        is_manual_mode = controller.is_manual();
+
+        taskENTER_CRITICAL();
+        for (uint8_t n = 0; n < SPOT_COUNT; n++)
         {
-            prev_servo_angle = (uint8_t)current_servo_angle;
-            mark_data_changed();
+            spots[n].release_counter = controller.release_counter(n);
+            spots[n].released = controller.released(n);
         }
+        taskEXIT_CRITICAL();
+
+        preopen_barrier(out.servo_units / SERVO_UNITS_PER_DEG, now);
+
+        for (uint8_t i = 0; i < out.event_count; i++)
+            mark_data_changed(out.events[i].type, out.events[i].value);
 
         // Update I2C registers
         soft_i2c_set_register(REG_SERVO_ANGLE, (uint8_t)current_servo_angle);
-        soft_i2c_set_register(REG_RELEASE_COUNTER, release_counter);
+        soft_i2c_set_register(REG_RELEASE_COUNTER, lane->release_counter);
+        soft_i2c_set_register(REG_FREE_SPOTS, out.free_spots);
+        status_frame_update();
 
-        vTaskDelay(pdMS_TO_TICKS(50));
+        supervisor_checkin(TASK_SERVO);
+        vTaskDelayUntil(&last_wake, SERVO_PERIOD_MS / portTICK_PERIOD_MS);
     }
 }
 
 // Task 4: LED Task
-// Controls all LEDs based on shared state (Light, Car, Counter).
+// Drives the LEDs from the shared state (Light, Car, Counter), with the
+// controller's truth table.
 static void vLedTask(void *p)
 {
+    leds_init();
+
     for(;;)
     {
-        uint8_t led_state = 0;
+        uint8_t led_state = Controller::leds(is_dark_state,
+                                             spots[BARRIER_SPOT].car,
+                                             spots[BARRIER_SPOT].released);
 
-        // White LED Control (Ambient Light)
-        if (is_dark_state)
-        {
-            PORTD |=  (1<<WHITE_LED);
-            led_state |= 0x04; // bit 2 for WHITE
-        }
-        else
+        WhiteLed::set(led_state & CONTROLLER_LED_WHITE);
+        RedLed::set(led_state & CONTROLLER_LED_RED);
+        GreenLed::set(led_state & CONTROLLER_LED_GREEN);
+
+        // Check if LED state changed
+        if (led_state != prev_led_state)
         {
-            PORTD &= ~(1<<WHITE_LED);
+            prev_led_state = led_state;
+            mark_data_changed(EVENT_LED, led_state);
         }
 
-        // Red/Green LED Control (Traffic Light)
-        if (car_state)
+        // Update I2C
+        soft_i2c_set_register(REG_LED_STATE, led_state);
+
+        supervisor_checkin(TASK_LED);
+        delay_ms_param(PARAM_LED_PERIOD_MS);
+    }
+}
+
+// Task 5: Journal Task
+// Commits coalesced state changes to the EEPROM journal and serves the
+// parameter window, so the EEPROM has a single writer. Low priority: the
+// EEPROM writes block this task, not the control tasks.
+static uint8_t journal_snapshot(void)
+{
+    uint8_t state = 0;
+
+    if (spots[BARRIER_SPOT].car) state |= JOURNAL_CAR;
+    if (is_dark_state)        state |= JOURNAL_DARK;
+    if (current_servo_angle)  state |= JOURNAL_BARRIER;
+    if (is_manual_mode)       state |= JOURNAL_MANUAL;
+    if (prev_led_state & CONTROLLER_LED_RED)   state |= JOURNAL_LED_RED;
+    if (prev_led_state & CONTROLLER_LED_GREEN) state |= JOURNAL_LED_GREEN;
+    if (prev_led_state & CONTROLLER_LED_WHITE) state |= JOURNAL_LED_WHITE;
+
+    return state;
+}
+
+static void vJournalTask(void *p)
+{
+    uint8_t committed_state = 0xFF;
+    TickType_t last_commit = 0;
+
+    journal_init();
+
+    for(;;)
+    {
+        // Rewind request from the master before a bulk read-out
+        if (soft_i2c_get_register(REG_JOURNAL_CTRL) == JOURNAL_CMD_REWIND)
         {
-            // Car detected -> RED (Stop/Occupied)
-            PORTD |=  (1<<RED_LED);
-            PORTD &= ~(1<<GREEN_LED);
-            led_state |= 0x01; // bit 0 for RED
+            journal_rewind();
+            soft_i2c_set_register(REG_JOURNAL_CTRL, 0);
         }
-        else
+
+        handle_param_command();
+
+        uint8_t state = journal_snapshot();
+        if (state != committed_state &&
+            (TickType_t)(xTaskGetTickCount() - last_commit) >= pdMS_TO_TICKS(JOURNAL_COMMIT_INTERVAL))
         {
-            if (current_release_counter >= BARRIER_OPEN_DURATION)
-            {
-                // Car gone + Delay passed -> GREEN (Free)
-                PORTD |=  (1<<GREEN_LED);
-                PORTD &= ~(1<<RED_LED);
-                led_state |= 0x02; // bit 1 for GREEN
-            }
-            else
-            {
-                // Car gone but still waiting -> maintain RED
-                PORTD |=  (1<<RED_LED);
-                PORTD &= ~(1<<GREEN_LED);
-                led_state |= 0x01; // bit 0 for RED
-            }
+            journal_append(sysmon_uptime_ms(), state);
+            committed_state = state;
+            last_commit = xTaskGetTickCount();
         }
 
-        // Check if LED state changed
-        if (led_state != prev_led_state)
+        soft_i2c_set_register(REG_JOURNAL_COUNT, journal_count());
+
+        supervisor_checkin(TASK_JOURNAL);
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+}
+
+// Task 6: Supervisor Task
+// Feeds the watchdog and advances the heartbeat only when every task has
+// checked in, and publishes the system health registers.
+// The status stays BOOTING until the first complete round.
+static void vSupervisorTask(void *p)
+{
+    bool booted = false;
+
+    supervisor_start_watchdog();
+
+    for(;;)
+    {
+        uint8_t all_alive = supervisor_update();
+        if (all_alive)
+            booted = true;
+
+        uint8_t status = !booted   ? SYS_STATUS_BOOTING :
+                         all_alive ? SYS_STATUS_OK : SYS_STATUS_STALLED;
+        soft_i2c_set_register(REG_SYSTEM_STATUS, status);
+        soft_i2c_set_register(REG_HEARTBEAT, supervisor_heartbeat());
+
+        // CPU load and scheduling latency
+        sysmon_update();
+        uint16_t tick_gap_max = sysmon_tick_gap_max();
+        soft_i2c_set_register(REG_CPU_LOAD_1S, sysmon_cpu_load_1s());
+        soft_i2c_set_register(REG_CPU_LOAD_60S, sysmon_cpu_load_60s());
+        soft_i2c_set_register(REG_TICK_GAP_MAX_L, tick_gap_max & 0xFF);
+        soft_i2c_set_register(REG_TICK_GAP_MAX_H, tick_gap_max >> 8);
+
+        vTaskDelay(pdMS_TO_TICKS(250));
+    }
+}
+
+#if TELEMETRY_ENABLE
+// Task 7: Telemetry Task
+// Streams the records pushed by the other tasks as they arrive, plus a
+// snapshot of the register bank every TELEMETRY_STATE_MS, on the USB serial
+// link (see telemetry.h).
+static void vTelemetryTask(void *p)
+{
+    const TickType_t period = TELEMETRY_STATE_MS / portTICK_PERIOD_MS;
+    TickType_t last_state = xTaskGetTickCount();
+
+    for(;;)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - last_state;
+        if (elapsed < period)
         {
-            prev_led_state = led_state;
-            mark_data_changed();
+            telemetry_send_next(period - elapsed);
+            continue;
         }
 
-        // Update I2C
-        soft_i2c_set_register(REG_LED_STATE, led_state);
-        soft_i2c_set_register(REG_SYSTEM_STATUS, 0x01);
-
-        vTaskDelay(pdMS_TO_TICKS(50));
+        // Static: a quarter of the TLM stack otherwise
+        static uint8_t regs[SOFT_I2C_REGISTER_COUNT];
+        taskENTER_CRITICAL();
+        latch_timestamps();
+        for (uint8_t i = 0; i < sizeof(regs); i++)
+            regs[i] = soft_i2c_get_register(i);
+        taskEXIT_CRITICAL();
+
+        telemetry_send(TLM_STATE, regs, sizeof(regs));
+        last_state = xTaskGetTickCount();
+        supervisor_checkin(TASK_TELEMETRY);
     }
 }
+#endif
 
 // ===================================================
 //                     MAIN
 // ===================================================
 int main(void)
 {
-    soft_i2c_init(0x32);   // adresse I2C esclave
+    // Fast boot: the I2C slave comes up first and answers BOOTING while the
+    // rest starts. Peripheral init is deferred into the tasks themselves.
+    // Reading the parameters is a few EEPROM reads (no write), it does not
+    // delay the slave noticeably.
+    params_load();
+    soft_i2c_init(params_get(PARAM_I2C_ADDRESS));   // adresse I2C esclave (0x32 par défaut)
+    soft_i2c_set_register(REG_SYSTEM_STATUS, SYS_STATUS_BOOTING);
+    soft_i2c_on_read(REG_UPTIME_0, latch_timestamps);
+    soft_i2c_on_stream(REG_EVENT_FIFO, event_fifo_send);
+    soft_i2c_on_stream(REG_JOURNAL_STREAM, journal_send_batch);
+    status_frame_init(params_get(PARAM_I2C_ADDRESS));
+    status_frame_update();
+    soft_i2c_on_stream(REG_STATUS_FRAME, status_frame_send);
+    soft_i2c_add_page(PAGE_CONFIG, params_values(), PARAM_COUNT * sizeof(uint16_t), 0);
+    soft_i2c_add_page(PAGE_STATS, sysmon_stats(), sizeof(sysmon_stats_t), 0);
+    soft_i2c_add_stream_page(PAGE_EVENTS, event_fifo_send);
+    soft_i2c_add_stream_page(PAGE_JOURNAL, journal_send_batch);
+    soft_i2c_add_page(PAGE_POLICY, hold_policy_stats(), sizeof(hold_stats_t), 0);
+    soft_i2c_add_page(PAGE_TRAFFIC, traffic_stats(), sizeof(traffic_stats_t), 0);
+    soft_i2c_add_page(PAGE_APPROACH, preopen_stats(), sizeof(preopen_stats_t), 0);
+    soft_i2c_add_stream_page(PAGE_OCCUPANCY, occupancy_send);
+    soft_i2c_add_page(PAGE_OCCUPANCY_RESET, occupancy_reset_slot(), sizeof(occupancy_reset_t), 1);
+    soft_i2c_add_page(PAGE_PROGRAM, prog_slot(), sizeof(prog_slot_t), 1);
+#if TRACE_ENABLE
+    soft_i2c_add_stream_page(PAGE_TRACE, trace_send_batch);
+#endif
+    soft_i2c_add_page(PAGE_BUS, soft_i2c_stats(), sizeof(soft_i2c_stats_t), 0);
+    soft_i2c_add_page_array(PAGE_SPOT_0, SPOT_COUNT, spots, sizeof(spot_t), 0);
+
+    // The TWI ISR only touches the register bank, it can run before the
+    // scheduler (the tick interrupt is only enabled by vTaskStartScheduler).
+    sei();
 
     // Initialiser les registres
     soft_i2c_set_register(REG_SERVO_COMMAND, 0);  // Pas de commande (0 = inactif)
     soft_i2c_set_register(REG_CHANGE_FLAG, 0);       // No changes yet
-    
-    leds_init();
-    light_sensor_init();
-    ir_init();
-    servo_init();   // now using Timer0 OC0A on D6
+    soft_i2c_set_register(REG_PARAM_CTRL, 0);
+    soft_i2c_set_register(REG_SPOT_COUNT, SPOT_COUNT);
+
+    supervisor_init(TASK_ALL);
+    soft_i2c_set_register(REG_RESET_CAUSE, supervisor_reset_cause());
+    soft_i2c_set_register(REG_REBOOT_COUNT, supervisor_reboot_count());
 
     lcdSem = xSemaphoreCreateBinary();
+#if TRACE_ENABLE
+    vQueueSetQueueNumber(lcdSem, TRACE_QUEUE_LCD);
+#endif
 
-    // Create Tasks
-    xTaskCreate(vIrTask,          "IR",   100, NULL, 3, NULL); // Detection priority
+    // Create Tasks (the creation order numbers the tasks in the kernel trace)
+    xTaskCreate(vIrTask,          "IR",   120, NULL, 3, NULL); // Detection priority
     xTaskCreate(vServoTask,       "SERV", 130, NULL, 2, NULL); // Logic priority
     xTaskCreate(vLedTask,         "LED",  100, NULL, 2, NULL); // Visual priority
     xTaskCreate(vLightSensorTask, "LGT",  80,  NULL, 1, NULL); // Low priority
+    xTaskCreate(vJournalTask,     "JRNL", 100, NULL, 1, NULL); // EEPROM writes
+    xTaskCreate(vSupervisorTask,  "SUP",  100, NULL, 3, NULL); // Watchdog / heartbeat
+#if TELEMETRY_ENABLE
+    telemetry_init(TELEMETRY_BAUD);
+    xTaskCreate(vTelemetryTask,   "TLM",  130, NULL, 1, NULL); // Serial telemetry
+#endif
     vTaskStartScheduler();
 
     while(1);
@@ -18,6 +18,10 @@ import time
 SLAVE_ADDRESS = 0x32
 I2C_BUS = 1
 
+# Benchmark de débit : transactions par tour, tours mesurés
+TIMING_TRANSACTIONS = 200
+TIMING_ROUNDS = 5
+
 def test_i2c_detection():
     """Test 1: Détection du slave I2C"""
     print("\n" + "="*60)
@@ -155,31 +159,37 @@ def test_continuous_read():
         return False
 
 def test_timing():
-    """Test 5: Performance de lecture"""
+    """Test 5: Benchmark de débit (reproductible)"""
     print("\n" + "="*60)
-    print("TEST 5: Performance de lecture")
+    print("TEST 5: Benchmark de débit")
     print("="*60)
-    
+
+    # Même mesure que `i2c_master.py --speed-probe` : nombre fixe de
+    # transactions sans pause, un tour de chauffe puis médiane de 5 tours
+    from i2c_master import ParkingMaster, display_speed_probe
+
     try:
-        bus = smbus2.SMBus(I2C_BUS)
-        iterations = 100
-        
-        start = time.time()
-        for _ in range(iterations):
-            bus.read_byte_data(SLAVE_ADDRESS, 0)
-        duration = time.time() - start
-        
-        avg_time = (duration / iterations) * 1000  # en ms
-        print(f"✓ {iterations} lectures effectuées en {duration:.2f}s")
-        print(f"  Temps moyen par lecture: {avg_time:.2f}ms")
-        print(f"  Fréquence max théorique: {1000/avg_time:.1f} Hz")
-        
-        bus.close()
-        return True
-        
+        master = ParkingMaster(bus_num=I2C_BUS, slave_addr=SLAVE_ADDRESS)
+    except Exception as e:
+        print(f"❌ Erreur: {e}")
+        return False
+
+    try:
+        probe = master.probe_speed(transactions=TIMING_TRANSACTIONS, rounds=TIMING_ROUNDS)
+        display_speed_probe(probe)
+        if probe['bus_hz'] is None:
+            print("  ⚠️  Fréquence du bus inconnue : comparer avec dtparam=i2c_arm_baudrate")
+
+        errors = sum(w['errors'] for w in probe['workloads'].values())
+        slave = probe['slave']
+        slow = slave['delta']['slow_isr'] if slave and slave['delta'] else 0
+        return errors == 0 and slow == 0
+
     except Exception as e:
         print(f"❌ Erreur: {e}")
         return False
+    finally:
+        master.close()
 
 def main():
     print("\n" + "🔧 "*20)
@@ -198,7 +208,7 @@ def main():
         tests_results.append(("Lecture registres", test_register_read()))
         tests_results.append(("Écriture registre", test_register_write()))
         tests_results.append(("Lecture continue", test_continuous_read()))
-        tests_results.append(("Performance", test_timing()))
+        tests_results.append(("Débit", test_timing()))
     else:
         print("\n⚠️  Tests suivants annulés (slave non détecté)")
     
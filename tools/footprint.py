@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+Occupation flash/RAM par module et par symbole (make footprint)
+
+Lit la carte du linker (-Wl,-Map) : seules les sections conservées par
+--gc-sections y figurent, chaque section d'entrée avec son objet d'origine.
+.text compte en flash, .data en flash et en RAM (valeurs initiales copiées
+au démarrage), .bss et .noinit en RAM. Les tailles des symboles viennent
+d'avr-nm, rattachés à leur module par adresse.
+
+Comparaison avec la référence enregistrée (make footprint-baseline) :
+un module échoue s'il dépasse sa taille de référence de plus de la marge
+autorisée dans tools/footprint_budget.json (growth, ou modules.<nom> pour
+une marge propre au module). Le total est de plus comparé à la capacité de
+la puce (flash hors bootloader, RAM moins la réserve pour la pile de main()).
+
+Usage : tools/footprint.py Build/ParkingRTOS.elf Build/ParkingRTOS.map [--baseline F] [--write-baseline]
+Code de retour 1 si un budget est dépassé.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+BUDGET = os.path.join(TOOLS_DIR, 'footprint_budget.json')
+BASELINE = os.path.join(TOOLS_DIR, 'footprint_baseline.json')
+
+# Section de sortie -> colonne du rapport
+OUTPUT_SECTIONS = {'.text': 'text', '.data': 'data', '.bss': 'bss', '.noinit': 'bss'}
+
+INPUT_RE = re.compile(r'^ (\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+INPUT_NAME_RE = re.compile(r'^ (\S+)$')
+INPUT_CONT_RE = re.compile(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+OUTPUT_RE = re.compile(r'^(\.\S+)(?:\s+0x[0-9a-f]+\s+0x[0-9a-f]+.*)?$')
+
+
+def module_name(origin):
+    """'Build/params.o' -> 'params', '.../libgcc.a(_udivmodsi4.o)' -> 'libgcc'"""
+    origin = origin.strip()
+    archive = re.match(r'(.*?)\.a\(', origin)
+    if archive:
+        return os.path.basename(archive.group(1))
+    if ' ' in origin:
+        return 'linker'     # "linker stubs"
+    return os.path.splitext(os.path.basename(origin))[0]
+
+
+def read_map(path):
+    """Liste (début, taille, colonne, module) des sections d'entrée conservées"""
+    with open(path) as f:
+        lines = f.read().splitlines()
+    try:
+        start = lines.index('Linker script and memory map')
+    except ValueError:
+        sys.exit(f"{path} : pas une carte de linker GNU ld")
+
+    sections = []
+    column = None
+    pending = None
+    for line in lines[start + 1:]:
+        out = OUTPUT_RE.match(line)
+        if out:
+            column = OUTPUT_SECTIONS.get(out.group(1))
+            pending = None
+            continue
+        if column is None:
+            continue
+
+        m = INPUT_RE.match(line)
+        if m:
+            name, address, size, origin = m.groups()
+        elif pending:
+            m = INPUT_CONT_RE.match(line)
+            name, pending = pending, None
+            if not m:
+                continue
+            address, size, origin = m.groups()
+        else:
+            m = INPUT_NAME_RE.match(line)
+            if m and not m.group(1).startswith('*'):
+                pending = m.group(1)
+            continue
+
+        if name == '*fill*' or name.startswith('*('):
+            continue
+        size = int(size, 16)
+        if size:
+            sections.append((int(address, 16), size, column, module_name(origin)))
+    return sorted(sections)
+
+
+def read_symbols(elf, nm, sections):
+    """({'module:symbole': taille}, {'module:symbole': colonne}) d'après avr-nm, rattachés par adresse"""
+    out = subprocess.run([nm, '-S', '-C', '--size-sort', elf],
+                         capture_output=True, text=True, check=True).stdout
+    symbols, columns = {}, {}
+    starts = [s[0] for s in sections]
+    for line in out.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4:
+            continue
+        address, size = int(fields[0], 16), int(fields[1], 16)
+        # Section d'entrée qui contient l'adresse (bissection sur les débuts)
+        lo, hi = 0, len(starts)
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if starts[mid] <= address:
+                lo = mid + 1
+            else:
+                hi = mid
+        if lo == 0:
+            continue
+        start, length, column, module = sections[lo - 1]
+        if address < start + length:
+            key = f'{module}:{fields[3]}'
+            symbols[key] = symbols.get(key, 0) + size
+            columns[key] = column
+    return symbols, columns
+
+
+def totals(sections):
+    modules = {}
+    for _, size, column, module in sections:
+        entry = modules.setdefault(module, {'text': 0, 'data': 0, 'bss': 0})
+        entry[column] += size
+    return modules
+
+
+def flash(m):
+    return m['text'] + m['data']
+
+
+def ram(m):
+    return m['data'] + m['bss']
+
+
+def signed(value):
+    return f'{value:+d}' if value else ''
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Occupation flash/RAM par module et par symbole")
+    parser.add_argument('elf')
+    parser.add_argument('map')
+    parser.add_argument('--nm', default='avr-nm')
+    parser.add_argument('--budget', default=BUDGET)
+    parser.add_argument('--baseline', default=BASELINE)
+    parser.add_argument('--config', default='', help="Options du build (SPOT_COUNT=...), mémorisées avec la référence")
+    parser.add_argument('--write-baseline', action='store_true', help="Enregistrer ce build comme référence")
+    parser.add_argument('--symbols', type=int, default=15, help="Nombre de symboles affichés (plus gros, plus fortes hausses)")
+    args = parser.parse_args()
+
+    sections = read_map(args.map)
+    modules = totals(sections)
+    symbols, columns = read_symbols(args.elf, args.nm, sections)
+
+    if args.write_baseline:
+        with open(args.baseline, 'w') as f:
+            json.dump({'config': args.config, 'modules': modules, 'symbols': symbols},
+                      f, indent=1, sort_keys=True)
+            f.write('\n')
+        print(f"Référence enregistrée dans {os.path.relpath(args.baseline)} ({args.config})")
+        return 0
+
+    with open(args.budget) as f:
+        budget = json.load(f)
+    baseline = None
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get('config') != args.config:
+            print(f"⚠ Référence mesurée avec {baseline.get('config') or '?'}, build actuel {args.config} :"
+                  " comparaison par module désactivée")
+            baseline = None
+    else:
+        print("⚠ Pas de référence : make footprint-baseline pour l'enregistrer")
+
+    failed = []
+    base_modules = baseline['modules'] if baseline else {}
+    print(f"\n{'Module':<16} {'.text':>6} {'.data':>6} {'.bss':>6} {'Flash':>6} {'RAM':>6} {'ΔFlash':>7} {'ΔRAM':>6}")
+    for name, m in sorted(modules.items(), key=lambda item: -(flash(item[1]) + ram(item[1]))):
+        line = f"{name:<16} {m['text']:>6} {m['data']:>6} {m['bss']:>6} {flash(m):>6} {ram(m):>6}"
+        ref = base_modules.get(name)
+        if baseline:
+            ref = ref or {'text': 0, 'data': 0, 'bss': 0}
+            d_flash, d_ram = flash(m) - flash(ref), ram(m) - ram(ref)
+            allowed = dict(budget['growth'], **budget.get('modules', {}).get(name, {}))
+            over = [kind for kind, delta in (('flash', d_flash), ('ram', d_ram)) if delta > allowed[kind]]
+            line += f" {signed(d_flash):>7} {signed(d_ram):>6}"
+            if over:
+                line += f"  ⚠ budget {'/'.join(over)} dépassé (marge {allowed['flash']} / {allowed['ram']} o)"
+                failed.append(name)
+        print(line.rstrip())
+
+    total = {k: sum(m[k] for m in modules.values()) for k in ('text', 'data', 'bss')}
+    ram_limit = budget['ram'] - budget['ram_reserve']
+    print(f"{'Total':<16} {total['text']:>6} {total['data']:>6} {total['bss']:>6} {flash(total):>6} {ram(total):>6}")
+    print(f"Flash {flash(total)} / {budget['flash']} o, RAM statique {ram(total)} / {ram_limit} o "
+          f"({budget['ram_reserve']} o réservés à la pile de main() et des ISR avant le scheduler)")
+    if flash(total) > budget['flash']:
+        failed.append('flash totale')
+    if ram(total) > ram_limit:
+        failed.append('RAM totale')
+
+    print("\nPlus gros symboles :")
+    for key, size in sorted(symbols.items(), key=lambda item: -item[1])[:args.symbols]:
+        print(f"  {size:>6} {columns[key]:<5} {key}")
+
+    if baseline:
+        base_symbols = baseline['symbols']
+        changes = {key: symbols.get(key, 0) - base_symbols.get(key, 0)
+                   for key in set(symbols) | set(base_symbols)}
+        changes = sorted(((d, k) for k, d in changes.items() if d), reverse=True)
+        if changes:
+            print("\nSymboles modifiés depuis la référence :")
+            for delta, key in changes[:args.symbols]:
+                print(f"  {delta:>+6} {key}" + (" (nouveau)" if key not in base_symbols else
+                                                  " (supprimé)" if key not in symbols else ""))
+
+    if failed:
+        print(f"\n❌ Budget dépassé : {', '.join(failed)}")
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+Pire cas d'utilisation de la pile par tâche FreeRTOS (make stack)
+
+Combine les fichiers .su produits par -fstack-usage (taille du cadre de
+chaque fonction, adresse de retour comprise) avec le graphe d'appels tiré du
+désassemblage de l'ELF (call, rcall et sauts vers une autre fonction).
+Les fonctions sans .su (libgcc, avr-libc, assembleur) sont estimées d'après
+leurs push et l'allocation de leur cadre.
+
+Pour chaque tâche : pile consommée depuis sa fonction d'entrée, plus le pire
+cadre d'interruption. Sur AVR les ISR s'exécutent sur la pile de la tâche
+interrompue et ne s'imbriquent pas (sauf `sei` dans l'ISR, signalé et alors
+compté en cumulant toutes les ISR). L'ISR du tick sauve le contexte complet
+(portSAVE_CONTEXT, 33 octets) avant d'appeler le noyau.
+
+Le résultat est un majorant : les appels indirects (icall) sont supposés
+pouvoir atteindre toute fonction dont l'adresse est prise, un saut terminal
+est compté comme un appel et une interruption est supposée possible au point
+le plus profond de chaque tâche.
+
+Usage : tools/stack_usage.py Build/ParkingRTOS.elf [--build Build] [--main main.cpp]
+Code de retour 1 si une pile est trop petite ou non bornée (récursion).
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+
+RETURN_ADDRESS = 2          # PC 16 bits de l'ATmega328p
+CONTEXT_SIZE = 33           # portSAVE_CONTEXT : r0, SREG, r1-r31
+# Fonctions nues du port qui sauvent le contexte sur la pile courante
+CONTEXT_SAVERS = ('vPortYield', 'vPortYieldFromTick')
+# Sauts indirects internes à la fonction appelante (tables de switch)
+TABLE_JUMPS = ('__tablejump__', '__tablejump2__')
+IDLE_TASK = ('IDLE', 'prvIdleTask')
+
+FUNCTION_RE = re.compile(r'^([0-9a-f]+) <(.+)>:$')
+INSN_RE = re.compile(r'^\s+[0-9a-f]+:\t(\w+)\s*([^;]*)(?:;\s*(.*))?$')
+TARGET_RE = re.compile(r'<(.+?)>\s*$')
+TASK_RE = re.compile(r'xTaskCreate\(\s*(\w+)\s*,\s*"([^"]*)"\s*,\s*(\w+)')
+
+
+def base_name(name):
+    """Nom sans paramètres ni type de retour : 'void Foo::bar(int)' -> 'Foo::bar'"""
+    name = name.split('(', 1)[0].strip()
+    depth = 0
+    for i in range(len(name) - 1, -1, -1):
+        c = name[i]
+        if c == '>':
+            depth += 1
+        elif c == '<':
+            depth -= 1
+        elif c == ' ' and depth == 0:
+            name = name[i + 1:]
+            break
+    return name.lstrip('*&')
+
+
+def demangle(names, tool):
+    """Démangle les symboles C++ en une seule passe de c++filt"""
+    mangled = sorted(n for n in names if n.startswith('_Z'))
+    if not mangled:
+        return {}
+    for cmd in (tool, 'c++filt'):
+        try:
+            out = subprocess.run([cmd], input='\n'.join(mangled), capture_output=True,
+                                 text=True, check=True).stdout.splitlines()
+            return dict(zip(mangled, out))
+        except (OSError, subprocess.CalledProcessError):
+            continue
+    return {}
+
+
+def read_su(build_dir):
+    """Taille de cadre par fonction (max si plusieurs fonctions statiques homonymes)"""
+    sizes = {}
+    for path in glob.glob(os.path.join(build_dir, '*.su')):
+        with open(path) as f:
+            for line in f:
+                fields = line.rstrip('\n').split('\t')
+                if len(fields) < 3:
+                    continue
+                # fichier:ligne:colonne:nom
+                name = base_name(fields[0].split(':', 3)[-1])
+                size = int(fields[1])
+                if 'dynamic' in fields[2] and 'bounded' not in fields[2]:
+                    size = None     # alloca / VLA : non borné
+                if size is None or (name in sizes and sizes[name] is None):
+                    sizes[name] = None
+                else:
+                    sizes[name] = max(size, sizes.get(name, 0))
+    return sizes
+
+
+class Function:
+    def __init__(self, name):
+        self.name = name
+        self.calls = set()
+        self.indirect = 0       # Nombre de icall/ijmp
+        self.pushes = 0
+        self.frame = 0
+        self.reads_sp = False   # in r28, SPL vu : l'instruction suivante alloue le cadre
+        self.sei = False
+
+
+def read_disassembly(elf, objdump):
+    """Graphe d'appels de l'ELF lié (seul le code conservé par --gc-sections)"""
+    out = subprocess.run([objdump, '-d', '-C', '--no-show-raw-insn', elf],
+                         capture_output=True, text=True, check=True).stdout
+    functions = {}
+    current = None
+    for line in out.splitlines():
+        m = FUNCTION_RE.match(line)
+        if m:
+            name = base_name(m.group(2))
+            current = functions.setdefault(name, Function(name))
+            continue
+        m = INSN_RE.match(line)
+        if not m or current is None:
+            continue
+        op, args, comment = m.group(1), m.group(2).strip(), m.group(3) or ''
+        if op == 'push':
+            current.pushes += 1
+        elif op == 'in' and args.replace(' ', '') == 'r28,0x3d':
+            current.reads_sp = True
+        elif op in ('sbiw', 'subi') and args.startswith('r28') and current.reads_sp:
+            # Allocation du cadre : in r28, SPL puis sbiw r28, N (subi/sbci au-delà de 63)
+            current.frame += int(args.split(',')[-1].strip(), 0) & 0xFF
+            current.reads_sp = False
+        elif op == 'sei':
+            current.sei = True
+        elif op in ('icall', 'eicall', 'ijmp', 'eijmp'):
+            if current.name not in TABLE_JUMPS:
+                current.indirect += 1
+        elif op in ('call', 'rcall', 'jmp', 'rjmp'):
+            t = TARGET_RE.search(comment)
+            if t and '+0x' not in t.group(1):
+                target = base_name(t.group(1))
+                if target != current.name:
+                    current.calls.add(target)
+    return functions
+
+
+def read_address_taken(build_dir, objdump, cxxfilt):
+    """Fonctions dont l'adresse est prise (relocations gs()/pm() des objets)"""
+    objects = glob.glob(os.path.join(build_dir, '*.o'))
+    if not objects:
+        return set()
+    out = subprocess.run([objdump, '-r', '-C'] + objects, capture_output=True, text=True).stdout
+    names = set()
+    for line in out.splitlines():
+        fields = line.split(None, 2)
+        if len(fields) == 3 and ('_GS' in fields[1] or '_PM' in fields[1]):
+            name = re.sub(r'[+-]0x[0-9a-f]+$', '', fields[2])
+            if name.startswith('.text.'):
+                name = name[len('.text.'):]
+            names.add(name)
+    demangled = demangle(names, cxxfilt)
+    return {base_name(demangled.get(n, n)) for n in names}
+
+
+def read_tasks(main_source, config_header):
+    """(nom, fonction d'entrée, taille de pile en octets) d'après xTaskCreate() et FreeRTOSConfig.h"""
+    with open(config_header) as f:
+        m = re.search(r'#define\s+configMINIMAL_STACK_SIZE\s+.*?(\d+)', f.read())
+    minimal = int(m.group(1))
+
+    tasks = [(IDLE_TASK[0], IDLE_TASK[1], minimal)]
+    with open(main_source) as f:
+        for entry, name, depth in TASK_RE.findall(f.read()):
+            tasks.append((name, entry, minimal if depth == 'configMINIMAL_STACK_SIZE' else int(depth, 0)))
+    return tasks
+
+
+class Analysis:
+    def __init__(self, functions, sizes, address_taken, task_entries):
+        self.functions = functions
+        self.sizes = sizes
+        self.estimated = set()
+        self.recursive = set()
+        self.memo = {}
+        # icall : toute fonction dont l'adresse est prise, sauf les points
+        # d'entrée des tâches et les ISR (jamais appelés par pointeur)
+        self.indirect_targets = sorted(
+            n for n in address_taken
+            if n in functions and n not in task_entries and not n.startswith('__vector_'))
+
+    def frame(self, name):
+        """Octets empilés par la fonction elle-même, adresse de retour comprise"""
+        f = self.functions.get(name)
+        if name in CONTEXT_SAVERS:
+            return RETURN_ADDRESS + CONTEXT_SIZE
+        if name.startswith('__vector_') and f is not None and f.pushes == 0:
+            return RETURN_ADDRESS     # ISR nue (tick) : le contexte est sauvé plus loin
+        size = self.sizes.get(name)
+        if size is not None:
+            return size
+        self.estimated.add(name)
+        if f is None:
+            return RETURN_ADDRESS
+        return RETURN_ADDRESS + f.pushes + f.frame
+
+    def depth(self, name, stack=()):
+        """(octets, chemin) du pire appel depuis name ; octets None si non borné"""
+        if name in self.memo:
+            return self.memo[name]
+        if name in stack:
+            self.recursive.update(stack[stack.index(name):])
+            return None, [name]
+        if name in self.sizes and self.sizes[name] is None:
+            return None, [name]
+
+        f = self.functions.get(name)
+        callees = set(f.calls) if f else set()
+        if f and f.indirect:
+            callees.update(self.indirect_targets)
+
+        worst, path = 0, []
+        for callee in sorted(callees):
+            d, p = self.depth(callee, stack + (name,))
+            if d is None:
+                self.memo[name] = (None, [name] + p)
+                return self.memo[name]
+            if d > worst:
+                worst, path = d, p
+
+        self.memo[name] = (self.frame(name) + worst, [name] + path)
+        return self.memo[name]
+
+    def reaches(self, name, predicate, seen=None):
+        seen = set() if seen is None else seen
+        if name in seen:
+            return False
+        seen.add(name)
+        f = self.functions.get(name)
+        if f is None:
+            return False
+        if predicate(f):
+            return True
+        callees = set(f.calls) | (set(self.indirect_targets) if f.indirect else set())
+        return any(self.reaches(c, predicate, seen) for c in callees)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pire cas de pile par tâche FreeRTOS")
+    parser.add_argument('elf')
+    parser.add_argument('--build', default='Build', help="Dossier des .o et .su")
+    parser.add_argument('--main', default='main.cpp', help="Source des xTaskCreate()")
+    parser.add_argument('--config', default='FreeRTOSConfig.h')
+    parser.add_argument('--objdump', default='avr-objdump')
+    parser.add_argument('--cxxfilt', default='avr-c++filt')
+    parser.add_argument('--verbose', '-v', action='store_true', help="Afficher le chemin de chaque pire cas")
+    args = parser.parse_args()
+
+    sizes = read_su(args.build)
+    if not sizes:
+        sys.exit(f"Aucun fichier .su dans {args.build} : recompiler (make clean && make)")
+    functions = read_disassembly(args.elf, args.objdump)
+    tasks = [t for t in read_tasks(args.main, args.config) if t[1] in functions]
+    analysis = Analysis(functions, sizes, read_address_taken(args.build, args.objdump, args.cxxfilt),
+                        {entry for _, entry, _ in tasks})
+
+    # Cadres d'interruption
+    isrs = []
+    for name in sorted(n for n in functions if re.fullmatch(r'__vector_\d+', n)):
+        d, path = analysis.depth(name)
+        isrs.append((name, d, path))
+    nesting = [name for name, _, _ in isrs if analysis.reaches(name, lambda f: f.sei)]
+    if any(d is None for _, d, _ in isrs):
+        isr_worst = None
+    elif nesting:
+        isr_worst = sum(d for _, d, _ in isrs)
+    else:
+        isr_worst = max((d for _, d, _ in isrs), default=0)
+
+    print("Interruptions (pile de la tâche interrompue) :")
+    for name, d, path in isrs:
+        print(f"  {name:<12} {d if d is not None else '?':>5}" + (f"   {' > '.join(path)}" if args.verbose else ''))
+    if nesting:
+        print(f"  ⚠ sei dans {', '.join(nesting)} : imbrication possible, cadres cumulés")
+    print()
+
+    failed = False
+    print(f"{'Tâche':<6} {'Entrée':<18} {'Pile':>5} {'Tâche':>6} {'+ISR':>5} {'Pire':>5} {'Marge':>6}")
+    for name, entry, stack_size in tasks:
+        d, path = analysis.depth(entry)
+        if d is None or isr_worst is None:
+            failed = True
+            print(f"{name:<6} {entry:<18} {stack_size:>5}  non borné : {' > '.join(path)}")
+            continue
+        total = d + isr_worst
+        margin = stack_size - total
+        failed |= margin < 0
+        print(f"{name:<6} {entry:<18} {stack_size:>5} {d:>6} {isr_worst:>5} {total:>5} {margin:>6}"
+              + ("  ⚠ TROP PETITE" if margin < 0 else ""))
+        if args.verbose:
+            print(f"       {' > '.join(path)}")
+
+    indirect = sorted(n for n, f in functions.items() if f.indirect and n not in TABLE_JUMPS)
+    if indirect:
+        print(f"\nAppels indirects ({len(analysis.indirect_targets)} cible(s) possible(s)) : {', '.join(indirect)}")
+    if analysis.recursive:
+        print(f"Récursion : {', '.join(sorted(analysis.recursive))}")
+    estimated = sorted(n for n in analysis.estimated if n in functions)
+    if estimated:
+        print(f"Sans .su, estimées d'après le code : {', '.join(estimated)}")
+    print("\nTailles en octets (StackType_t = 1 octet sur AVR). Marge = pile allouée - pire cas.")
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
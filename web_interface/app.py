@@ -15,16 +15,37 @@ from i2c_master import ParkingMaster
 
 app = Flask(__name__, static_folder='static')
 
-# Global parking master instance
-# Initialize it lazily or on startup
-try:
-    master = ParkingMaster()
-    print("✅ ParkingMaster initialized successfully")
-except Exception as e:
-    print(f"⚠️ Error initializing ParkingMaster: {e}")
-    # We might be running locally without I2C, creating a mock for testing if needed
-    # For now, we assume it works or fails hard.
-    master = None
+# Delay between two attempts to open the link (seconds)
+MASTER_RETRY_INTERVAL = 5.0
+
+# Link to the firmware (see open_link in i2c_master.py): i2c:1@0x32,
+# serial:/dev/ttyACM0 or sim: to run without hardware. Default: I2C bus 1.
+PARKING_LINK = os.environ.get('PARKING_LINK')
+
+# Global parking master instance, created lazily and retried on failure
+# (bus not ready yet, Arduino still booting...) instead of giving up at import
+master = None
+_last_master_attempt = None
+
+
+def get_master():
+    global master, _last_master_attempt
+    if master is not None:
+        return master
+
+    now = time.monotonic()
+    if _last_master_attempt is not None and now - _last_master_attempt < MASTER_RETRY_INTERVAL:
+        return None
+    _last_master_attempt = now
+
+    try:
+        master = ParkingMaster(link=PARKING_LINK)
+        print("✅ ParkingMaster initialized successfully")
+    except Exception as e:
+        print(f"⚠️ Error initializing ParkingMaster: {e}")
+        master = None
+    return master
+
 
 @app.route('/')
 def index():
@@ -36,29 +57,32 @@ def serve_static(path):
 
 @app.route('/api/status')
 def get_status():
+    master = get_master()
     if master:
         try:
             status = master.get_all_status()
             if status:
                 return jsonify(status)
+            elif master.is_booting():
+                return jsonify({"error": "Firmware booting", "booting": True}), 503
             else:
                 return jsonify({"error": "Failed to read status"}), 500
         except Exception as e:
             return jsonify({"error": str(e)}), 500
     else:
-        # Mock data for testing if hardware not available
-        return jsonify({
-            'car_detected': False,
-            'is_dark': False,
-            'servo_angle': 0,
-            'led_red': True,
-            'led_green': False,
-            'led_white': False,
-            'release_counter': 0
-        })
+        # Without hardware, run with PARKING_LINK=sim: for simulated data
+        return jsonify({"error": "Hardware not connected"}), 503
+
+@app.route('/api/link')
+def get_link_stats():
+    master = get_master()
+    if not master:
+        return jsonify({"error": "Hardware not connected"}), 503
+    return jsonify(master.link_stats())
 
 @app.route('/api/servo', methods=['POST'])
 def set_servo():
+    master = get_master()
     if not master:
         return jsonify({"error": "Hardware not connected"}), 503
         